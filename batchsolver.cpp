@@ -0,0 +1,34 @@
+#include <atomic>
+#include "batchsolver.h"
+
+using namespace std;
+
+BatchSolver::BatchSolver(int threads) : pool(threads), solvers(pool.size()) {
+}
+
+vector<string> BatchSolver::solve(const vector<string_view> &mazes) {
+    return solve(mazes, ENGINE_AUTO);
+}
+
+vector<string> BatchSolver::solve(const vector<string_view> &mazes, SolveEngine engine) {
+    vector<string> results;
+    solveInto(mazes.data(), mazes.size(), results, engine);
+    return results;
+}
+
+size_t BatchSolver::solveInto(const string_view *mazes, size_t count,
+                              vector<string> &results, SolveEngine engine) {
+    results.resize(count);
+    atomic<size_t> solved(0);
+    // One maze per chunk: sizes vary too much for larger chunks
+    // to balance, and a solve dwarfs the cost of taking a chunk.
+    pool.parallelFor(count, 1, [&](size_t begin, size_t end, int worker) {
+        MazeSolver &solver = solvers[worker];
+        for (size_t i = begin; i < end; i++) {
+            results[i].assign(mazes[i]);
+            if (solver.solveInto(mazes[i], &results[i][0], engine))
+                solved++;
+        }
+    });
+    return solved;
+}
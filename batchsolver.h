@@ -0,0 +1,40 @@
+#ifndef BATCHSOLVER_H
+#define BATCHSOLVER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include "mazesolver.h"
+#include "threadpool.h"
+
+using namespace std;
+
+// Solves many independent mazes in parallel.
+//
+// The mazes are spread over a work-stealing ThreadPool, and each
+// worker keeps its own MazeSolver, so graph, queue and parent
+// buffers are reused from one maze to the next. Results come back
+// in input order. One batch runs at a time per BatchSolver.
+class BatchSolver
+{
+    public:
+        // Uses the given number of threads; 0 means one per hardware thread.
+        BatchSolver(int threads);
+
+        // Returns solve(mazes[i], engine) for every i.
+        vector<string> solve(const vector<string_view> &mazes);
+        vector<string> solve(const vector<string_view> &mazes, SolveEngine engine);
+
+        // Same as solve(), but writes into results so their storage
+        // is reused across batches. Returns the number of mazes solved.
+        size_t solveInto(const string_view *mazes, size_t count,
+                         vector<string> &results, SolveEngine engine);
+
+        int threads() const { return pool.size(); }
+
+    private:
+        ThreadPool pool;
+        vector<MazeSolver> solvers; // One per worker
+};
+
+#endif
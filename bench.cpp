@@ -0,0 +1,255 @@
+// Benchmarks the maze engines on generated mazes.
+//
+// Build it like the tests, with bench.cpp in place of main.cpp:
+//     g++ -O2 -DMAZE_STATS -pthread bench.cpp <every other .cpp but main.cpp and solverd.cpp> -o bench
+//
+// Usage:
+//     bench [--sizes 100,1000,10000] [--kinds perfect,rooms,corridors,portals]
+//           [--engines heap,bucket,astar,implicit,parallel,bitbfs,jps,auto,corridor]
+//           [--repeat 3] [--seed 1] [--format json|csv]
+//
+// Each run solves the maze through a MazeSolver, exactly as solve()
+// would, and prints one record: the maze, the engine, the time spent
+// in each phase (parse, scan, build, search, render) in nanoseconds,
+// as SolveStats reports it, the number
+// and bytes of heap allocations made during the run, and the peak
+// resident set size. Records are JSON objects, one per line, or CSV
+// rows under a header line. Repeats reuse the same buffers, so the
+// first run of each configuration shows the cold costs and the others
+// the steady state.
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "mazegen.h"
+#include "mazesolver.h"
+#include "solve.h"
+
+#ifndef MAZE_STATS
+#error "bench reads the phase times from SolveStats: build everything with -DMAZE_STATS"
+#endif
+
+using namespace std;
+
+// Allocation counting: every operator new in the process goes through
+// here, so the counts include allocations inside the standard library.
+// The default pmr resource, which every MazeSolver buffer comes from,
+// allocates through the aligned forms, so those are counted too.
+static atomic<size_t> allocCount(0);
+static atomic<size_t> allocBytes(0);
+
+void *operator new(size_t n) {
+    allocCount.fetch_add(1, memory_order_relaxed);
+    allocBytes.fetch_add(n, memory_order_relaxed);
+    if (void *p = malloc(n ? n : 1))
+        return p;
+    throw bad_alloc();
+}
+
+void *operator new[](size_t n) {
+    return operator new(n);
+}
+
+void operator delete(void *p) noexcept {
+    free(p);
+}
+
+void operator delete[](void *p) noexcept {
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept {
+    free(p);
+}
+
+void *operator new(size_t n, align_val_t align) {
+    allocCount.fetch_add(1, memory_order_relaxed);
+    allocBytes.fetch_add(n, memory_order_relaxed);
+    // aligned_alloc() wants a nonzero multiple of the alignment.
+    size_t a = (size_t)align;
+    size_t rounded = n ? (n + a - 1) / a * a : a;
+    if (void *p = aligned_alloc(a, rounded))
+        return p;
+    throw bad_alloc();
+}
+
+void *operator new[](size_t n, align_val_t align) {
+    return operator new(n, align);
+}
+
+void operator delete(void *p, align_val_t) noexcept {
+    free(p);
+}
+
+void operator delete[](void *p, align_val_t) noexcept {
+    free(p);
+}
+
+void operator delete(void *p, size_t, align_val_t) noexcept {
+    free(p);
+}
+
+void operator delete[](void *p, size_t, align_val_t) noexcept {
+    free(p);
+}
+
+// Helper function: asks the kernel to reset the peak RSS to the current
+// RSS. Returns false where /proc/self/clear_refs is not available; the
+// peak then covers the whole process so far.
+static bool resetPeakRss() {
+    ofstream f("/proc/self/clear_refs");
+    if (!f)
+        return false;
+    f << "5";
+    return (bool)f.flush();
+}
+
+// Helper function: peak resident set size in KiB, from VmHWM.
+static long peakRssKb() {
+    ifstream f("/proc/self/status");
+    string line;
+    while (getline(f, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0)
+            return atol(line.c_str() + 6);
+    }
+    return -1;
+}
+
+// What one run measured.
+struct BenchRun
+{
+    SolveStats stats;
+    size_t allocs = 0;
+    size_t allocBytes = 0;
+    long peakRssKb = -1;
+    bool rssReset = false;
+    bool found = false;
+};
+
+// Helper function: solves maze with one engine through solver, which
+// keeps its buffers across runs.
+static BenchRun runOnce(const string &maze, SolveEngine engine, MazeSolver &solver, string &out) {
+    BenchRun run;
+    out.resize(maze.size());
+    run.rssReset = resetPeakRss();
+    size_t allocsBefore = allocCount.load(), bytesBefore = allocBytes.load();
+    run.found = solver.solveInto(maze, &out[0], engine, &run.stats);
+    run.allocs = allocCount.load() - allocsBefore;
+    run.allocBytes = allocBytes.load() - bytesBefore;
+    run.peakRssKb = peakRssKb();
+    return run;
+}
+
+// Helper function: splits a comma-separated list.
+static vector<string> splitList(const string &s) {
+    vector<string> items;
+    stringstream in(s);
+    string item;
+    while (getline(in, item, ','))
+        if (!item.empty())
+            items.push_back(item);
+    return items;
+}
+
+static int usage() {
+    cerr << "usage: bench [--sizes N,...] [--kinds perfect,rooms,corridors,portals]\n"
+            "             [--engines heap,bucket,astar,implicit,parallel,bitbfs,jps,auto,corridor]\n"
+            "             [--repeat N] [--seed N] [--format json|csv]\n";
+    return 2;
+}
+
+int main(int argc, char **argv) {
+    vector<int> sizes = {100, 1000, 10000};
+    vector<MazeKind> kinds = {MAZE_PERFECT, MAZE_ROOMS, MAZE_CORRIDORS, MAZE_PORTALS};
+    vector<SolveEngine> engines;
+    for (int e = 0; e < ENGINE_COUNT; e++)
+        engines.push_back((SolveEngine)e);
+    int repeat = 3;
+    unsigned seed = 1;
+    bool csv = false;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (i + 1 >= argc)
+            return usage();
+        string value = argv[++i];
+        if (arg == "--sizes") {
+            sizes.clear();
+            for (const string &s : splitList(value))
+                sizes.push_back(atoi(s.c_str()));
+        } else if (arg == "--kinds") {
+            kinds.clear();
+            for (const string &s : splitList(value)) {
+                MazeKind k;
+                if (!parseMazeKind(s, k))
+                    return usage();
+                kinds.push_back(k);
+            }
+        } else if (arg == "--engines") {
+            engines.clear();
+            for (const string &s : splitList(value)) {
+                SolveEngine e;
+                if (!parseSolveEngine(s, e))
+                    return usage();
+                engines.push_back(e);
+            }
+        } else if (arg == "--repeat") {
+            repeat = atoi(value.c_str());
+        } else if (arg == "--seed") {
+            seed = strtoul(value.c_str(), nullptr, 10);
+        } else if (arg == "--format") {
+            if (value != "json" && value != "csv")
+                return usage();
+            csv = value == "csv";
+        } else {
+            return usage();
+        }
+    }
+    for (int size : sizes)
+        if (size < 3)
+            return usage();
+
+    if (csv)
+        printf("kind,size,engine,seed,run,found,path_cells,parse_ns,scan_ns,build_ns,search_ns,"
+               "render_ns,total_ns,allocs,alloc_bytes,peak_rss_kb,rss_reset\n");
+
+    for (MazeKind kind : kinds) {
+        for (int size : sizes) {
+            string maze = generateMaze(kind, size, size, seed);
+            for (SolveEngine engine : engines) {
+                // A fresh solver per engine, so the first run is cold.
+                MazeSolver solver;
+                string out;
+                for (int r = 0; r < repeat; r++) {
+                    BenchRun run = runOnce(maze, engine, solver, out);
+                    const SolveStats &st = run.stats;
+                    long long total = st.parseNs + st.scanNs + st.buildNs + st.searchNs + st.renderNs;
+                    const char *fmt = csv
+                        ? "%s,%d,%s,%u,%d,%d,%zu,%lld,%lld,%lld,%lld,%lld,%lld,%zu,%zu,%ld,%d\n"
+                        : "{\"kind\":\"%s\",\"size\":%d,\"engine\":\"%s\",\"seed\":%u,"
+                          "\"run\":%d,\"found\":%d,\"path_cells\":%zu,"
+                          "\"parse_ns\":%lld,\"scan_ns\":%lld,\"build_ns\":%lld,\"search_ns\":%lld,"
+                          "\"render_ns\":%lld,\"total_ns\":%lld,\"allocs\":%zu,"
+                          "\"alloc_bytes\":%zu,\"peak_rss_kb\":%ld,\"rss_reset\":%d}\n";
+                    printf(fmt, mazeKindName(kind), size, solveEngineName(engine), seed, r,
+                           (int)run.found, st.pathLength, st.parseNs, st.scanNs, st.buildNs,
+                           st.searchNs, st.renderNs, total, run.allocs, run.allocBytes,
+                           run.peakRssKb, (int)run.rssReset);
+                    fflush(stdout);
+                }
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,120 @@
+#include "bitsearch.h"
+
+using namespace std;
+
+bool bitParallelBfs(const MazeGrid &grid, const MazeScan &scan, SearchScratch &s) {
+    const ViewArray<uint64_t> &walls = scan.walls;
+    size_t words = walls.size();
+    uint32_t perRow = scan.wordsPerRow;
+
+    // unseen holds the open cells not reached yet, so one load and
+    // mask per word decides which cells a move reaches.
+    pmr::vector<uint64_t> &unseen = s.unseen;
+    unseen.resize(words);
+    for (size_t i = 0; i < words; i++)
+        unseen[i] = ~walls[i];
+    s.level[0].assign(words, 0);
+    s.level[1].assign(words, 0);
+    s.front.assign(words, 0);
+    s.next.assign(words, 0);
+    s.frontWords.clear();
+    s.nextWords.clear();
+
+    // Cells as (word index, bit).
+    auto wordOf = [&](uint32_t cell) {
+        return (uint32_t)(cell / grid.stride * perRow + cell % grid.stride / 64);
+    };
+    auto bitOf = [&](uint32_t cell) { return 1ull << (cell % grid.stride % 64); };
+    uint32_t goalWord = wordOf(scan.goal);
+    uint64_t goalBit = bitOf(scan.goal);
+    uint32_t startWord = wordOf(scan.start);
+    s.front[startWord] = bitOf(scan.start);
+    unseen[startWord] &= ~bitOf(scan.start);
+    s.frontWords.push_back(startWord);
+    s.counters.push(1);
+
+    uint64_t *next = s.next.data();
+    uint64_t *level0 = s.level[0].data(), *level1 = s.level[1].data();
+    uint64_t mask0 = 0, mask1 = 0;
+
+    // Helper: adds the unseen open cells of bits to word t of the next
+    // level, recording the level mod 3 through mask0 and mask1.
+    auto reach = [&](uint32_t t, uint64_t bits) {
+        bits &= unseen[t];
+        if (!bits)
+            return;
+        if (!next[t])
+            s.nextWords.push_back(t);
+        next[t] |= bits;
+        unseen[t] &= ~bits;
+        level0[t] |= bits & mask0;
+        level1[t] |= bits & mask1;
+    };
+
+    int depth = 0;
+    while (unseen[goalWord] & goalBit) {
+        if (s.frontWords.empty())
+            return false;
+        depth++;
+        mask0 = depth % 3 == 1 ? ~0ull : 0;
+        mask1 = depth % 3 == 2 ? ~0ull : 0;
+        uint64_t *front = s.front.data();
+        for (uint32_t i : s.frontWords) {
+            uint64_t f = front[i];
+            front[i] = 0;
+            s.counters.pop(__builtin_popcountll(f));
+            s.counters.settle(__builtin_popcountll(f));
+            uint32_t w = i % perRow;
+            reach(i, f << 1 | f >> 1);
+            if (w > 0 && (f & 1))
+                reach(i - 1, 1ull << 63);
+            if (w + 1 < perRow && (f >> 63))
+                reach(i + 1, 1);
+            if (i >= perRow)
+                reach(i - perRow, f);
+            if (i + perRow < words)
+                reach(i + perRow, f);
+        }
+        swap(s.front, s.next);
+        swap(s.frontWords, s.nextWords);
+        s.nextWords.clear();
+        next = s.next.data();
+
+        // The whole next level is queued at once.
+        if (SearchCounters::enabled) {
+            size_t cells = 0;
+            for (uint32_t i : s.frontWords)
+                cells += __builtin_popcountll(s.front[i]);
+            s.counters.push(cells, cells);
+        }
+    }
+
+    // Walk back from the goal, each step to a reached neighbor one
+    // level lower, trying up, down, left, right in turn.
+    s.parent.resize((size_t)grid.rows * grid.stride);
+    auto levelIs = [&](int r, int c, int mod) {
+        if (r < 0 || r >= grid.rows || c < 0 || c >= grid.cols)
+            return false;
+        size_t i = (size_t)r * perRow + c / 64;
+        uint64_t bit = 1ull << (c % 64);
+        if ((walls[i] | unseen[i]) & bit)
+            return false;
+        int m = (level0[i] & bit ? 1 : 0) | (level1[i] & bit ? 2 : 0);
+        return m == mod;
+    };
+    const int dr[4] = {-1, 1, 0, 0};
+    const int dc[4] = {0, 0, -1, 1};
+    int r = scan.goal / grid.stride, c = scan.goal % grid.stride;
+    for (int k = depth; k > 0; k--) {
+        int mod = (k - 1) % 3;
+        int d = 0;
+        while (!levelIs(r + dr[d], c + dc[d], mod))
+            d++;
+        uint32_t cell = grid.offset(r, c);
+        r += dr[d];
+        c += dc[d];
+        s.parent[cell] = grid.offset(r, c);
+    }
+    s.parent[scan.start] = MazeScan::NONE;
+    return true;
+}
@@ -0,0 +1,29 @@
+#ifndef BITSEARCH_H
+#define BITSEARCH_H
+
+#include "mazegrid.h"
+#include "mazescan.h"
+#include "search.h"
+
+using namespace std;
+
+// Breadth-first search on the scan's packed wall bitmap, for mazes
+// where every move costs 1 (no portal pairs).
+//
+// The frontier is a set of 64-cell words: one level expands every
+// active word at once with shifts for left and right moves and plain
+// copies for up and down, masked by the open cells not yet seen. Only
+// words that hold frontier cells are touched, so long corridors cost
+// a few word operations per level. Each cell's level mod 3 is kept in
+// two more bitmaps; since neighbors' levels differ by at most one,
+// that is enough to walk back from the goal along levels L, L-1, ..., 0.
+//
+// Cells are named by their offset in the maze string, as in MazeScan.
+// Fills s.parent along the path only (up to the start, whose parent
+// is MazeScan::NONE) and returns whether scan.goal was reached.
+// Portals are ignored; use another engine when scan.portals is not empty.
+//
+// Runs in O(s) time, and O(s / 64) for each level of open area.
+bool bitParallelBfs(const MazeGrid &grid, const MazeScan &scan, SearchScratch &s);
+
+#endif
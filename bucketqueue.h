@@ -0,0 +1,113 @@
+#ifndef BUCKETQUEUE_H
+#define BUCKETQUEUE_H
+
+#include <memory_resource>
+#include <vector>
+using namespace std;
+
+// A monotone bucket queue (Dial's algorithm) for integer priorities
+// when every edge costs between 0 and MaxCost.
+//
+// Live priorities always lie in [cur, cur + MaxCost], so a circular
+// array of MaxCost + 1 buckets holds them all. Pushing a priority
+// equal to the current minimum (a 0-cost edge) lands in the bucket
+// being drained and is served next, without any scan.
+//
+// Priorities are ints unless P names a wider integer type.
+//
+// There is no decrease_key: push the value again with its lower
+// priority and skip stale entries when they come out, by comparing
+// frontPriority() with the best known cost.
+template <typename T, int MaxCost = 9, typename P = int>
+class BucketQueue
+{
+    static const int BUCKETS = MaxCost + 1;
+
+    pmr::vector< pmr::vector<T> > B; // Bucket p % BUCKETS holds priority p.
+    P cur;                // Priority of the lowest bucket that may be non-empty.
+    int n;                // Number of entries.
+
+public:
+
+    // Creates an empty BucketQueue
+    BucketQueue() : B(BUCKETS)
+    {
+        cur = 0;
+        n = 0;
+    }
+
+    // Creates an empty BucketQueue that allocates from memory
+    BucketQueue(pmr::memory_resource *memory) : B(BUCKETS, memory)
+    {
+        cur = 0;
+        n = 0;
+    }
+
+    // Returns the number of entries, stale ones included.
+    //
+    // Runs in O(1) time.
+    int size()
+    {
+        return n;
+    }
+
+    // Pushes x with priority p.
+    // Undefined behavior unless p is within [cur, cur + MaxCost],
+    // where cur is the last popped priority (0 before any pop).
+    //
+    // Runs in O(1) amortized time.
+    void push(T x, P p)
+    {
+        B[p % BUCKETS].push_back(x);
+        n++;
+    }
+
+    // Returns the value at the front of the BucketQueue.
+    // Undefined behavior if the BucketQueue is empty.
+    //
+    // Runs in O(MaxCost) time.
+    T front()
+    {
+        advance();
+        return B[cur % BUCKETS].back();
+    }
+
+    // Returns the priority of the front value.
+    // Undefined behavior if the BucketQueue is empty.
+    P frontPriority()
+    {
+        advance();
+        return cur;
+    }
+
+    // Removes the value at the front of the BucketQueue.
+    // Undefined behavior if the BucketQueue is empty.
+    //
+    // Runs in O(MaxCost) time.
+    void pop()
+    {
+        advance();
+        B[cur % BUCKETS].pop_back();
+        n--;
+    }
+
+    // Removes every entry but keeps the bucket storage.
+    void clear()
+    {
+        for (int i = 0; i < BUCKETS; i++)
+            B[i].clear();
+        cur = 0;
+        n = 0;
+    }
+
+private:
+
+    // Moves cur forward to the first non-empty bucket.
+    void advance()
+    {
+        while (B[cur % BUCKETS].empty())
+            cur++;
+    }
+};
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef CELLSTATE_H
+#define CELLSTATE_H
+
+#include <cstddef>
+#include <cstdint>
+#include "mazegrid.h"
+#include "mazescan.h"
+#include "pathout.h"
+
+using namespace std;
+
+// Compact per-cell search state for the searches over maze offsets.
+//
+// Instead of a 32-bit parent, a search can keep the direction of each
+// cell's parent, which fits in three bits. Packed parent codes take
+// four bits a cell, two cells to a byte. A search sets the code of
+// every cell it reaches before the path is walked back, so the array
+// never needs clearing.
+enum ParentCode { FROM_NONE, FROM_UP, FROM_DOWN, FROM_LEFT, FROM_RIGHT, FROM_PORTAL };
+
+// Bytes of packed parent codes for cells offsets.
+inline size_t parentCodeBytes(size_t cells) {
+    return (cells + 1) / 2;
+}
+
+inline void setParentCode(uint8_t *codes, uint32_t cell, ParentCode code) {
+    int shift = cell % 2 * 4;
+    codes[cell / 2] = (codes[cell / 2] & ~(0xF << shift)) | code << shift;
+}
+
+inline ParentCode getParentCode(const uint8_t *codes, uint32_t cell) {
+    return (ParentCode)(codes[cell / 2] >> (cell % 2 * 4) & 0xF);
+}
+
+// Whether every offset and path cost of a maze with the given number
+// of offsets fits in 16 bits, with the largest value left to mean
+// none. A shortest path enters each cell at most once and takes each
+// of the ten portals at most once, so it costs less than cells + 90.
+inline bool fitsNarrow(size_t cells) {
+    return cells + 90 < 0xFFFF;
+}
+
+// Helper function: puts the path in out by following the packed
+// parent codes back from scan.goal to scan.start. out may mark the
+// maze itself: each cell's portal digit is read before the cell is
+// marked. Returns the number of cells on the path.
+inline size_t markParents(const MazeGrid &grid, const MazeScan &scan, const uint8_t *codes, PathOut out) {
+    size_t marked = 0;
+    uint32_t cur = scan.goal;
+    while (true) {
+        uint32_t from = cur;
+        if (cur != scan.start) {
+            switch (getParentCode(codes, cur)) {
+            case FROM_UP:
+                from = cur - grid.stride;
+                break;
+            case FROM_DOWN:
+                from = cur + grid.stride;
+                break;
+            case FROM_LEFT:
+                from = cur - 1;
+                break;
+            case FROM_RIGHT:
+                from = cur + 1;
+                break;
+            default:
+                const uint32_t *ends = scan.ends[grid.data[cur] - '0'];
+                from = ends[0] == cur ? ends[1] : ends[0];
+                break;
+            }
+        }
+        out.add(cur);
+        marked++;
+        if (cur == scan.start)
+            return marked;
+        cur = from;
+    }
+}
+
+#endif
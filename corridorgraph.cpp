@@ -0,0 +1,178 @@
+#include <climits>
+#include "corridorgraph.h"
+
+using namespace std;
+
+// Flags in CorridorGraph::degree, above the neighbor count.
+static const uint8_t VERTEX = 0x40;
+static const uint8_t CLOSED = 0x80; // A wall, a newline or a filled dead end
+static const int UNSEEN = INT_MAX;
+
+// Helper function: the offsets beside v, up, down, left, right, that
+// lie inside the maze. Left and right of a row end are newlines.
+static int besideCells(uint32_t v, uint32_t stride, size_t cells, uint32_t *beside) {
+    int count = 0;
+    if (v >= stride)
+        beside[count++] = v - stride;
+    if (v + stride < cells)
+        beside[count++] = v + stride;
+    if (v > 0)
+        beside[count++] = v - 1;
+    beside[count++] = v + 1;
+    return count;
+}
+
+void buildCorridorGraph(const MazeGrid &grid, const MazeScan &scan, CorridorGraph &g) {
+    const char *maze = grid.data;
+    size_t cells = (size_t)grid.rows * grid.stride;
+    uint32_t stride = grid.stride;
+    pmr::vector<uint8_t> &degree = g.degree;
+
+    // Exits and portal cells stay vertices whatever their neighbors.
+    auto kept = [&](uint32_t v) {
+        char ch = maze[v];
+        if (ch >= '0' && ch <= '9' && scan.ends[ch - '0'][0] != MazeScan::NONE)
+            return true;
+        return v == scan.start || v == scan.goal;
+    };
+
+    // Count the open neighbors of every open cell.
+    degree.resize(cells);
+    for (size_t v = 0; v < cells; v++)
+        degree[v] = maze[v] == '#' || maze[v] == '\n' ? CLOSED : 0;
+    uint32_t beside[4];
+    for (uint32_t v = 0; v < cells; v++) {
+        if (degree[v] == CLOSED)
+            continue;
+        int count = besideCells(v, stride, cells, beside);
+        for (int i = 0; i < count; i++)
+            degree[v] += degree[beside[i]] != CLOSED;
+    }
+
+    // Fill dead ends from their tips. Filling a cell takes a neighbor
+    // off the cell beside it, which may make that cell a tip too.
+    pmr::vector<uint32_t> &pending = g.pending;
+    pending.clear();
+    for (uint32_t v = 0; v < cells; v++) {
+        if (degree[v] <= 1 && !kept(v))
+            pending.push_back(v);
+    }
+    g.filled = 0;
+    while (!pending.empty()) {
+        uint32_t v = pending.back();
+        pending.pop_back();
+        degree[v] = CLOSED;
+        g.filled++;
+        int count = besideCells(v, stride, cells, beside);
+        for (int i = 0; i < count; i++) {
+            uint32_t n = beside[i];
+            if (degree[n] != CLOSED && --degree[n] == 1 && !kept(n))
+                pending.push_back(n);
+        }
+    }
+
+    // Every open cell that is not inside a chain is a vertex.
+    g.cellPos.clear();
+    g.vertexOf.resize(cells);
+    for (uint32_t v = 0; v < cells; v++) {
+        if (degree[v] != CLOSED && (degree[v] != 2 || kept(v))) {
+            degree[v] |= VERTEX;
+            g.vertexOf[v] = g.cellPos.size();
+            g.cellPos.push_back(v);
+        }
+    }
+
+    // Follow each chain from both of its ends, so every edge is listed
+    // from its source. A chain that comes back where it began is
+    // dropped, since no shortest path takes it.
+    g.offsets.assign(1, 0);
+    g.targets.clear();
+    g.weights.clear();
+    g.pathOffsets.assign(1, 0);
+    g.pathCells.clear();
+    for (uint32_t id = 0; id < g.size(); id++) {
+        uint32_t v = g.cellPos[id];
+        int count = besideCells(v, stride, cells, beside);
+        for (int i = 0; i < count; i++) {
+            uint32_t prev = v, cur = beside[i];
+            if (degree[cur] == CLOSED)
+                continue;
+            uint32_t weight = 1;
+            size_t begin = g.pathCells.size();
+            while (!(degree[cur] & VERTEX)) {
+                g.pathCells.push_back(cur);
+                uint32_t along[4];
+                int n = besideCells(cur, stride, cells, along);
+                uint32_t next = cur;
+                for (int j = 0; j < n; j++) {
+                    if (along[j] != prev && degree[along[j]] != CLOSED)
+                        next = along[j];
+                }
+                prev = cur;
+                cur = next;
+                weight++;
+            }
+            if (cur == v) {
+                g.pathCells.resize(begin);
+                continue;
+            }
+            g.targets.push_back(g.vertexOf[cur]);
+            g.weights.push_back(weight);
+            g.pathOffsets.push_back(g.pathCells.size());
+        }
+
+        char ch = maze[v];
+        if (ch >= '0' && ch <= '9') {
+            const uint32_t *ends = scan.ends[ch - '0'];
+            if (ends[0] != MazeScan::NONE) {
+                g.targets.push_back(g.vertexOf[ends[0] == v ? ends[1] : ends[0]]);
+                g.weights.push_back(ch - '0');
+                g.pathOffsets.push_back(g.pathCells.size());
+            }
+        }
+        g.offsets.push_back(g.targets.size());
+    }
+    g.start = g.vertexOf[scan.start];
+    g.goal = g.vertexOf[scan.goal];
+}
+
+bool dijkstraCorridors(const CorridorGraph &g, SearchScratch &s) {
+    pmr::vector<int> &costSoFar = s.costSoFar;
+    pmr::vector<uint32_t> &parent = s.parent;
+    costSoFar.assign(g.size(), UNSEEN);
+    parent.assign(g.size(), CorridorGraph::NONE);
+    MinPriorityQueue<uint32_t, 4> &frontier = s.heap;
+    frontier.clear();
+    frontier.reserve(g.size());
+    frontier.push(g.start, 0);
+    s.counters.push(1);
+    costSoFar[g.start] = 0;
+
+    while (frontier.size() > 0) {
+        uint32_t current = frontier.front();
+        frontier.pop();
+        s.counters.pop();
+        s.counters.settle();
+        int currentCost = costSoFar[current];
+
+        if (current == g.goal)
+            return true;
+
+        for (uint32_t e = g.offsets[current]; e < g.offsets[current + 1]; e++) {
+            uint32_t next = g.targets[e];
+            int newCost = currentCost + g.weights[e];
+            if (costSoFar[next] == UNSEEN) {
+                costSoFar[next] = newCost;
+                parent[next] = e;
+                frontier.push(next, newCost);
+                s.counters.push(frontier.size());
+            } else if (newCost < costSoFar[next]) {
+                costSoFar[next] = newCost;
+                parent[next] = e;
+                frontier.decrease_key(next, newCost);
+                s.counters.decreaseKey();
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,90 @@
+#ifndef CORRIDORGRAPH_H
+#define CORRIDORGRAPH_H
+
+#include <algorithm>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+#include "mazegrid.h"
+#include "mazescan.h"
+#include "search.h"
+
+using namespace std;
+
+// A maze reduced to its junctions, in CSR form like MazeGraph.
+//
+// Dead ends that hold no exit or portal can never be on a shortest
+// path, so they are filled in first, a cell at a time from the tip,
+// until every branch left leads somewhere. What remains is mostly
+// chains of cells with two open neighbors. The vertices are every
+// other cell: junctions, exits and portal cells. Each edge is one
+// chain, weighted by its length, and keeps the chain's cells so a path
+// can be marked cell by cell.
+//
+// Vertex ids follow row-major order. The edges leaving vertex v are
+// targets[offsets[v]] through targets[offsets[v+1] - 1], listed up,
+// down, left, right, then the portal jump. The cells edge e passes
+// through, from its source side, are pathCells[pathOffsets[e]]
+// through pathCells[pathOffsets[e+1] - 1].
+class CorridorGraph
+{
+    public:
+        static constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+        CorridorGraph() {}
+        CorridorGraph(pmr::memory_resource *memory) :
+            cellPos(memory), offsets(memory), targets(memory), weights(memory),
+            pathOffsets(memory), pathCells(memory),
+            degree(memory), vertexOf(memory), pending(memory)
+        {
+        }
+
+        // Offset in the maze string of each vertex
+        pmr::vector<uint32_t> cellPos;
+
+        // CSR edge arrays
+        pmr::vector<uint32_t> offsets;
+        pmr::vector<uint32_t> targets;
+        pmr::vector<uint32_t> weights;
+
+        // The cells inside each edge's chain
+        pmr::vector<uint32_t> pathOffsets;
+        pmr::vector<uint32_t> pathCells;
+
+        // The exits, or NONE
+        uint32_t start = NONE;
+        uint32_t goal = NONE;
+
+        // Open cells filled as dead ends
+        size_t filled = 0;
+
+        uint32_t size() const { return cellPos.size(); }
+
+        // The vertex edge e leaves
+        uint32_t source(uint32_t e) const
+        {
+            return upper_bound(offsets.begin(), offsets.end(), e) - offsets.begin() - 1;
+        }
+
+        // Build scratch, by offset: open neighbors left, with flags for
+        // closed cells and vertices, and the vertex id of each vertex cell
+        pmr::vector<uint8_t> degree;
+        pmr::vector<uint32_t> vertexOf;
+        pmr::vector<uint32_t> pending;
+};
+
+// Fills the dead ends of a maze grid and builds the graph of what is
+// left. The grid must have both exits.
+//
+// Runs in O(s) time.
+void buildCorridorGraph(const MazeGrid &grid, const MazeScan &scan, CorridorGraph &g);
+
+// Dijkstra's algorithm on a CorridorGraph with a 4-ary MinPriorityQueue.
+// Fills s.parent with the edge each vertex was reached by
+// (CorridorGraph::NONE for the start and for unreached vertices)
+// and returns whether the goal was reached.
+//
+// Runs in O(E*log(V)) time.
+bool dijkstraCorridors(const CorridorGraph &g, SearchScratch &s);
+
+#endif
@@ -0,0 +1,200 @@
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include "dynamicsolver.h"
+#include "mazegrid.h"
+
+using namespace std;
+
+static const long long UNREACHED = LLONG_MAX;
+static const long long STEP_COST = (1ll << 32) + 1;
+
+DynamicMazeSolver::DynamicMazeSolver(string_view maze) : cells(maze) {
+    restart();
+}
+
+// Helper function: the open cells one move from cell and the move
+// costs, up, down, left, right, then the portal jump. Every move can
+// be made both ways at the same cost, so these are also the cells a
+// move into cell can come from.
+//
+// A move costs its maze cost in the high 32 bits plus one step. LPA*
+// needs every edge to cost more than 0: two ends of a '0' portal
+// would otherwise keep each other's stale cost alive after the path
+// to them is cut. Counting steps only breaks ties between paths of
+// the same maze cost.
+int DynamicMazeSolver::neighbors(uint32_t cell, uint32_t next[5], long long weight[5]) const {
+    uint32_t stride = cells.stride();
+    size_t size = (size_t)cells.rows() * stride;
+    int count = 0;
+    uint32_t adjacent[4] = {
+        cell >= stride ? cell - stride : NONE,
+        cell + stride < size ? cell + stride : NONE,
+        cell > 0 ? cell - 1 : NONE,
+        cell + 1
+    };
+    for (int i = 0; i < 4; i++) {
+        if (adjacent[i] != NONE && cells.open(adjacent[i])) {
+            next[count] = adjacent[i];
+            weight[count++] = STEP_COST;
+        }
+    }
+    uint32_t jump = cells.partner(cell);
+    if (jump != NONE) {
+        next[count] = jump;
+        weight[count++] = ((long long)(cells.at(cell) - '0') << 32) + 1;
+    }
+    return count;
+}
+
+// Helper function: forgets every cost and seeds the search at start.
+void DynamicMazeSolver::restart() {
+    size_t size = cells.text().size();
+    g.assign(size, UNREACHED);
+    rhs.assign(size, UNREACHED);
+    frontier.clear();
+    frontier.reserve(size);
+    uint32_t start = cells.start();
+    if (start == NONE)
+        return;
+    rhs[start] = 0;
+    frontier.push(start, 0);
+}
+
+// Helper function: recomputes rhs of cell from its neighbors and
+// queues the cell if that leaves it inconsistent.
+void DynamicMazeSolver::updateCell(uint32_t cell) {
+    if (cell != cells.start()) {
+        long long best = UNREACHED;
+        if (cells.open(cell)) {
+            uint32_t next[5];
+            long long weight[5];
+            int count = neighbors(cell, next, weight);
+            for (int i = 0; i < count; i++)
+                if (g[next[i]] != UNREACHED)
+                    best = min(best, g[next[i]] + weight[i]);
+        }
+        rhs[cell] = best;
+    }
+    bool queued = frontier.contains(cell);
+    if (g[cell] == rhs[cell]) {
+        if (queued)
+            frontier.remove(cell);
+    } else if (queued) {
+        frontier.update(cell, min(g[cell], rhs[cell]));
+    } else {
+        frontier.push(cell, min(g[cell], rhs[cell]));
+    }
+}
+
+// Helper function: settles inconsistent cells, cheapest first, until
+// the goal is consistent and nothing cheaper than it is waiting.
+// Cells tied with the goal are settled too, so that every cell on a
+// shortest path is consistent when the path is traced back.
+void DynamicMazeSolver::repair() {
+    uint32_t goal = cells.goal();
+    if (goal == NONE)
+        return;
+    while (frontier.size() > 0) {
+        uint32_t u = frontier.front();
+        long long key = min(g[u], rhs[u]);
+        if (key > min(g[goal], rhs[goal]) && g[goal] == rhs[goal])
+            break;
+        frontier.pop();
+
+        uint32_t next[5];
+        long long weight[5];
+        int count = neighbors(u, next, weight);
+        if (g[u] > rhs[u]) {
+            // Overconsistent: the cost went down; pass it on.
+            g[u] = rhs[u];
+        } else {
+            // Underconsistent: the cost went up; drop it and let the
+            // cell and everything it fed find new costs.
+            g[u] = UNREACHED;
+            updateCell(u);
+        }
+        for (int i = 0; i < count; i++)
+            updateCell(next[i]);
+    }
+}
+
+bool DynamicMazeSolver::update(int row, int col, char ch) {
+    if (row < 0 || row >= cells.rows() || col < 0 || col >= cells.cols() || ch == '\n')
+        return false;
+    uint32_t cell = cells.offset(row, col);
+    char old = cells.at(cell);
+    if (old == ch)
+        return true;
+
+    // Cells whose incoming moves may change: the cell, its neighbors,
+    // and both ends of the portals of the old and new digits, before
+    // and after the change.
+    vector<uint32_t> touched;
+    auto addPortals = [&](char d) {
+        if (d >= '0' && d <= '9' && cells.digitCells(d - '0').size() == 2)
+            touched.insert(touched.end(), cells.digitCells(d - '0').begin(), cells.digitCells(d - '0').end());
+    };
+    addPortals(old);
+    addPortals(ch);
+    uint32_t oldStart = cells.start();
+    cells.set(row, col, ch);
+    addPortals(old);
+    addPortals(ch);
+    touched.push_back(cell);
+
+    // Moving the first exit changes the search's source; the goal is
+    // read afresh by each query.
+    if (cells.start() != oldStart) {
+        restart();
+        return true;
+    }
+
+    uint32_t next[5];
+    long long weight[5];
+    int count = neighbors(cell, next, weight);
+    for (int i = 0; i < count; i++)
+        touched.push_back(next[i]);
+    for (uint32_t v : touched)
+        updateCell(v);
+    return true;
+}
+
+int DynamicMazeSolver::cost() {
+    repair();
+    uint32_t goal = cells.goal();
+    if (goal == NONE || g[goal] == UNREACHED)
+        return -1;
+    return g[goal] >> 32;
+}
+
+string DynamicMazeSolver::solve() {
+    string solution(cells.text());
+    solveInto(&solution[0]);
+    return solution;
+}
+
+bool DynamicMazeSolver::solveInto(char *out) {
+    memcpy(out, cells.text().data(), cells.text().size());
+    if (cost() < 0)
+        return false;
+
+    // Walk back from the goal, each step to a neighbor whose cost plus
+    // the move gives the current cell's cost. Every move costs at
+    // least one step, so the walk always gets closer to the start.
+    uint32_t next[5];
+    long long weight[5];
+    uint32_t cur = cells.goal();
+    out[cur] = 'o';
+    while (cur != cells.start()) {
+        int count = neighbors(cur, next, weight);
+        int i = 0;
+        while (i < count && (g[next[i]] == UNREACHED || g[next[i]] + weight[i] != g[cur]))
+            i++;
+        if (i == count)
+            return false;
+        cur = next[i];
+        out[cur] = 'o';
+    }
+    return true;
+}
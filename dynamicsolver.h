@@ -0,0 +1,70 @@
+#ifndef DYNAMICSOLVER_H
+#define DYNAMICSOLVER_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "editablemaze.h"
+#include "minpriorityqueue.h"
+
+using namespace std;
+
+// Solves one maze again and again while a few of its cells change.
+//
+// The shortest-path tree from the first exit is kept between queries
+// and repaired with Lifelong Planning A* (LPA*), here with a zero
+// heuristic so that portals and a moving goal never invalidate a key.
+// Every cell has a cost g and a one-step lookahead rhs, the cheapest
+// g of a neighbor plus the move into the cell; cells where the two
+// differ wait in a priority queue. update() only marks the cells whose
+// edges changed, and the next query settles those and whatever depends
+// on them up to the cost of the goal, so a re-query costs time in
+// proportion to the part of the tree that actually changed.
+//
+// Changing which cell is the first exit restarts the search from
+// scratch, since every cost is measured from it.
+//
+// Cells are named by their offset in the maze string, as in MazeScan.
+// Not safe to share between threads.
+class DynamicMazeSolver
+{
+    public:
+        // Copies maze; the first query runs the full search.
+        DynamicMazeSolver(string_view maze);
+
+        // Sets the cell at (row, col) to ch: '#', ' ' or a digit.
+        // Returns false, changing nothing, if (row, col) is outside
+        // the maze or ch is a newline.
+        bool update(int row, int col, char ch);
+
+        // The maze with every update applied.
+        const string &maze() const { return cells.text(); }
+
+        // Returns the cost of a shortest path between the exits, or -1
+        // if there is none.
+        int cost();
+
+        // Same as solve(maze()), reusing the previous search.
+        string solve();
+
+        // Same as solveInto(maze(), out). Returns whether a path was found.
+        bool solveInto(char *out);
+
+    private:
+        static constexpr uint32_t NONE = EditableMaze::NONE;
+
+        int neighbors(uint32_t cell, uint32_t next[5], long long weight[5]) const;
+        void restart();
+        void updateCell(uint32_t cell);
+        void repair();
+
+        EditableMaze cells;
+
+        // LPA* state by cell offset
+        vector<long long> g;
+        vector<long long> rhs;
+        MinPriorityQueue<uint32_t, 4, long long> frontier;
+};
+
+#endif
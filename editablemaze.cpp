@@ -0,0 +1,66 @@
+#include <algorithm>
+#include "editablemaze.h"
+#include "mazegrid.h"
+
+using namespace std;
+
+EditableMaze::EditableMaze(string_view maze) : cells(maze) {
+    MazeGrid grid = parseMaze(cells);
+    height = grid.rows;
+    width = grid.cols;
+    size_t count = (size_t)height * stride();
+    for (uint32_t cell = 0; cell < count; cell++) {
+        char ch = cells[cell];
+        if (ch >= '0' && ch <= '9')
+            digits[ch - '0'].push_back(cell);
+    }
+    findExits();
+}
+
+uint32_t EditableMaze::partner(uint32_t cell) const {
+    char ch = cells[cell];
+    if (ch < '0' || ch > '9')
+        return NONE;
+    const vector<uint32_t> &ends = digits[ch - '0'];
+    if (ends.size() != 2)
+        return NONE;
+    return ends[0] == cell ? ends[1] : ends[0];
+}
+
+// Helper function: finds the first two open boundary cells in
+// row-major order.
+void EditableMaze::findExits() {
+    first = second = NONE;
+    for (int r = 0; r < height && second == NONE; r++) {
+        bool edgeRow = r == 0 || r == height - 1;
+        for (int c = 0; c < width && second == NONE; c += edgeRow || width == 1 ? 1 : width - 1) {
+            uint32_t cell = offset(r, c);
+            if (!open(cell))
+                continue;
+            if (first == NONE)
+                first = cell;
+            else
+                second = cell;
+        }
+    }
+}
+
+bool EditableMaze::set(int row, int col, char ch) {
+    if (row < 0 || row >= height || col < 0 || col >= width || ch == '\n')
+        return false;
+    uint32_t cell = offset(row, col);
+    char old = cells[cell];
+    if (old == ch)
+        return true;
+
+    if (old >= '0' && old <= '9') {
+        vector<uint32_t> &list = digits[old - '0'];
+        list.erase(find(list.begin(), list.end(), cell));
+    }
+    if (ch >= '0' && ch <= '9')
+        digits[ch - '0'].push_back(cell);
+    cells[cell] = ch;
+    if (onBoundary(row, col))
+        findExits();
+    return true;
+}
@@ -0,0 +1,67 @@
+#ifndef EDITABLEMAZE_H
+#define EDITABLEMAZE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+// A copy of a maze that is changed one cell at a time, for the solvers
+// that answer again after each change. Besides the text it keeps what
+// they all look up between changes: the exits, and every cell holding
+// each digit, so portals are found without a scan.
+//
+// Cells are named by their offset in the maze string, as in MazeScan.
+class EditableMaze
+{
+    public:
+        static constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+        // Copies maze.
+        EditableMaze(string_view maze);
+
+        // Sets the cell at (row, col) to ch: '#', ' ' or a digit.
+        // Returns false, changing nothing, if (row, col) is outside
+        // the maze or ch is a newline.
+        bool set(int row, int col, char ch);
+
+        const string &text() const { return cells; }
+        char at(uint32_t cell) const { return cells[cell]; }
+        int rows() const { return height; }
+        int cols() const { return width; }
+        uint32_t stride() const { return width + 1; }
+        uint32_t offset(int row, int col) const { return (uint32_t)row * stride() + col; }
+        bool onBoundary(int row, int col) const
+        {
+            return row == 0 || row == height - 1 || col == 0 || col == width - 1;
+        }
+
+        // The first two open boundary cells in row-major order, or NONE.
+        uint32_t start() const { return first; }
+        uint32_t goal() const { return second; }
+
+        // Whether a cell can be stood on. The newline that ends each
+        // row counts as a wall, so moves never wrap around.
+        bool open(uint32_t cell) const { return cells[cell] != '#' && cells[cell] != '\n'; }
+
+        // The other end of the portal at cell, or NONE.
+        uint32_t partner(uint32_t cell) const;
+
+        // Every cell holding the digit d; it is a portal if there are
+        // exactly two.
+        const vector<uint32_t> &digitCells(int d) const { return digits[d]; }
+
+    private:
+        void findExits();
+
+        string cells;
+        int height = 0;
+        int width = 0;
+        uint32_t first = NONE;
+        uint32_t second = NONE;
+        vector<uint32_t> digits[10];
+};
+
+#endif
@@ -0,0 +1,19 @@
+#include <cerrno>
+#include <unistd.h>
+#include "fdio.h"
+
+using namespace std;
+
+bool writeFull(int fd, const void *data, size_t n) {
+    const char *p = (const char *)data;
+    while (n > 0) {
+        ssize_t put = write(fd, p, n);
+        if (put < 0 && errno == EINTR)
+            continue;
+        if (put <= 0)
+            return false;
+        p += put;
+        n -= put;
+    }
+    return true;
+}
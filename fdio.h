@@ -0,0 +1,12 @@
+#ifndef FDIO_H
+#define FDIO_H
+
+#include <cstddef>
+
+using namespace std;
+
+// Writes all n bytes at data to the file descriptor fd, retrying
+// short writes and interrupted ones. Returns false on an error.
+bool writeFull(int fd, const void *data, size_t n);
+
+#endif
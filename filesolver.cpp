@@ -0,0 +1,289 @@
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "bucketqueue.h"
+#include "cellstate.h"
+#include "filesolver.h"
+#include "pagedfile.h"
+
+using namespace std;
+
+// Per-cell state: the settled flag and the ParentCode of the parent.
+static const uint8_t SETTLED = 0x80;
+
+// Queue entries pack the cell offset with the parent direction it
+// would be settled with, so no per-cell distance is ever stored.
+static const int CODE_SHIFT = 61;
+static const uint64_t CELL_MASK = ((uint64_t)1 << CODE_SHIFT) - 1;
+static const uint64_t NO_CELL = UINT64_MAX;
+
+// The shape, exits and portals of a maze file, from one sequential read.
+struct FileMaze
+{
+    uint64_t size = 0;
+    uint64_t stride = 0;
+    uint64_t rows = 0;
+    uint64_t cols = 0;
+    uint64_t start = NO_CELL;
+    uint64_t goal = NO_CELL;
+    uint64_t ends[10][2]; // Portal ends by digit, NO_CELL if unused
+};
+
+// Helper class: closes a file descriptor on scope exit.
+class FileHandle
+{
+    public:
+        FileHandle(int fd) : fd(fd) {}
+        ~FileHandle() { if (fd >= 0) ::close(fd); }
+        int fd;
+};
+
+// Helper function: reads the maze once in fixed-size chunks, finding its
+// shape, its first two boundary exits and the portals. Returns false on
+// a read error.
+static bool scanFile(int fd, FileMaze &m) {
+    static const size_t CHUNK = 1 << 20;
+    string buffer(CHUNK, '\0');
+    uint64_t count[10] = {0};
+    for (int d = 0; d < 10; d++)
+        m.ends[d][0] = m.ends[d][1] = NO_CELL;
+
+    uint64_t pos = 0, row = 0, col = 0;
+    bool shaped = false;
+    while (true) {
+        ssize_t got = pread(fd, &buffer[0], CHUNK, pos);
+        if (got < 0)
+            return false;
+        if (got == 0)
+            break;
+        for (ssize_t i = 0; i < got; i++, pos++) {
+            char ch = buffer[i];
+            if (ch == '\n') {
+                if (!shaped) {
+                    m.cols = col;
+                    m.stride = col + 1;
+                    m.rows = m.size / m.stride;
+                    shaped = true;
+                }
+                row++;
+                col = 0;
+                continue;
+            }
+            uint64_t c = col++;
+            // Cells past the last full row are ignored, as in parseMaze.
+            if (ch == '#' || (shaped && row >= m.rows))
+                continue;
+            // Row 0 is all boundary, so its width need not be known yet.
+            if (row == 0 || c == 0 || row == m.rows - 1 || c == m.cols - 1) {
+                if (m.start == NO_CELL)
+                    m.start = pos;
+                else if (m.goal == NO_CELL)
+                    m.goal = pos;
+            }
+            if (ch >= '0' && ch <= '9') {
+                int d = ch - '0';
+                if (count[d] < 2)
+                    m.ends[d][count[d]] = pos;
+                count[d]++;
+            }
+        }
+    }
+    // Only digits that appear exactly twice form a portal.
+    for (int d = 0; d < 10; d++)
+        if (count[d] != 2)
+            m.ends[d][0] = m.ends[d][1] = NO_CELL;
+    return shaped;
+}
+
+// Helper function: copies the input file to the output file.
+static bool copyFile(int in, int out, uint64_t size) {
+    static const size_t CHUNK = 1 << 20;
+    string buffer(CHUNK, '\0');
+    uint64_t pos = 0;
+    while (pos < size) {
+        ssize_t got = pread(in, &buffer[0], CHUNK, pos);
+        if (got <= 0)
+            return false;
+        for (ssize_t done = 0; done < got; ) {
+            ssize_t put = pwrite(out, &buffer[done], got - done, pos + done);
+            if (put <= 0)
+                return false;
+            done += put;
+        }
+        pos += got;
+    }
+    return true;
+}
+
+// Helper function: picks a page size giving each of two paged files
+// half the budget in at least 16 pages.
+static size_t pageSizeFor(size_t memoryBudget, size_t &pagesPerFile) {
+    size_t systemPage = sysconf(_SC_PAGESIZE);
+    size_t share = memoryBudget / 2;
+    size_t page = systemPage;
+    while (page * 2 <= share / 16 && page < ((size_t)4 << 20))
+        page *= 2;
+    pagesPerFile = share / page;
+    if (pagesPerFile < 4)
+        pagesPerFile = 4;
+    return page;
+}
+
+// Helper function: Dijkstra with a BucketQueue over the paged maze,
+// recording each settled cell's parent direction in state.
+// Returns 1 if the goal was reached, 0 if not, -1 on a mapping error.
+static int search(const FileMaze &m, PagedFile &maze, PagedFile &state) {
+    BucketQueue<uint64_t, 9, long long> frontier;
+    frontier.push(m.start | ((uint64_t)FROM_NONE << CODE_SHIFT), 0);
+
+    while (frontier.size() > 0) {
+        long long currentCost = frontier.frontPriority();
+        uint64_t entry = frontier.front();
+        frontier.pop();
+        uint64_t current = entry & CELL_MASK;
+
+        // The first entry popped for a cell carries its shortest cost.
+        uint8_t *st = (uint8_t *)state.at(current);
+        if (!st)
+            return -1;
+        if (*st & SETTLED)
+            continue;
+        *st = SETTLED | (uint8_t)(entry >> CODE_SHIFT);
+        if (current == m.goal)
+            return 1;
+
+        const char *here = maze.at(current);
+        if (!here)
+            return -1;
+        char ch = *here;
+
+        // Neighbors: up, down, left, right, then the portal jump,
+        // each with the direction leading back to current.
+        uint64_t next[5];
+        int weight[5];
+        uint64_t code[5];
+        int count = 0;
+        if (current >= m.stride)
+            next[count] = current - m.stride, weight[count] = 1, code[count++] = FROM_DOWN;
+        if (current + m.stride < m.rows * m.stride)
+            next[count] = current + m.stride, weight[count] = 1, code[count++] = FROM_UP;
+        if (current > 0)
+            next[count] = current - 1, weight[count] = 1, code[count++] = FROM_RIGHT;
+        next[count] = current + 1, weight[count] = 1, code[count++] = FROM_LEFT;
+        if (ch >= '0' && ch <= '9' && m.ends[ch - '0'][0] != NO_CELL) {
+            const uint64_t *ends = m.ends[ch - '0'];
+            next[count] = ends[0] == current ? ends[1] : ends[0];
+            weight[count] = ch - '0';
+            code[count++] = FROM_PORTAL;
+        }
+
+        for (int i = 0; i < count; i++) {
+            const char *cell = maze.at(next[i]);
+            if (!cell)
+                return -1;
+            if (*cell == '#' || *cell == '\n')
+                continue;
+            const uint8_t *seen = (const uint8_t *)state.at(next[i]);
+            if (!seen)
+                return -1;
+            if (*seen & SETTLED)
+                continue;
+            frontier.push(next[i] | (code[i] << CODE_SHIFT), currentCost + weight[i]);
+        }
+    }
+    return 0;
+}
+
+// Helper function: follows the parent directions from the goal back to
+// the start, writing 'o' over each cell of the output.
+static bool markPath(const FileMaze &m, PagedFile &out, PagedFile &state) {
+    uint64_t cur = m.goal;
+    while (true) {
+        const uint8_t *st = (const uint8_t *)state.at(cur);
+        char *cell = out.at(cur);
+        if (!st || !cell)
+            return false;
+        int code = *st & 7;
+        char ch = *cell;
+        *cell = 'o';
+        switch (code) {
+        case FROM_UP:
+            cur -= m.stride;
+            break;
+        case FROM_DOWN:
+            cur += m.stride;
+            break;
+        case FROM_LEFT:
+            cur -= 1;
+            break;
+        case FROM_RIGHT:
+            cur += 1;
+            break;
+        case FROM_PORTAL:
+            cur = m.ends[ch - '0'][0] == cur ? m.ends[ch - '0'][1] : m.ends[ch - '0'][0];
+            break;
+        default:
+            return true;
+        }
+    }
+}
+
+FileSolveResult solveFile(const char *inPath, const char *outPath) {
+    return solveFile(inPath, outPath, DEFAULT_FILE_BUDGET);
+}
+
+FileSolveResult solveFile(const char *inPath, const char *outPath, size_t memoryBudget) {
+    FileHandle in(open(inPath, O_RDONLY));
+    if (in.fd < 0)
+        return FILE_ERROR;
+    struct stat info;
+    if (fstat(in.fd, &info) != 0)
+        return FILE_ERROR;
+
+    FileMaze m;
+    m.size = info.st_size;
+    bool shaped = scanFile(in.fd, m);
+
+    // Unsolved mazes are written out as they are.
+    FileHandle out(open(outPath, O_RDWR | O_CREAT | O_TRUNC, 0644));
+    if (out.fd < 0 || !copyFile(in.fd, out.fd, m.size))
+        return FILE_ERROR;
+    if (!shaped || m.start == NO_CELL || m.goal == NO_CELL)
+        return FILE_UNSOLVED;
+
+    // The search state lives in an unlinked, initially sparse file
+    // next to the output, one zero byte (unsettled) per maze byte.
+    string statePath = string(outPath) + ".state.XXXXXX";
+    FileHandle stateFile(mkstemp(&statePath[0]));
+    if (stateFile.fd < 0)
+        return FILE_ERROR;
+    unlink(statePath.c_str());
+    if (ftruncate(stateFile.fd, m.size) != 0)
+        return FILE_ERROR;
+
+    size_t pages;
+    size_t pageBytes = pageSizeFor(memoryBudget, pages);
+    PagedFile state;
+    if (!state.open(stateFile.fd, m.size, true, pageBytes, pages))
+        return FILE_ERROR;
+
+    int found;
+    {
+        PagedFile maze;
+        if (!maze.open(in.fd, m.size, false, pageBytes, pages))
+            return FILE_ERROR;
+        found = search(m, maze, state);
+    }
+    if (found < 0)
+        return FILE_ERROR;
+    if (found == 0)
+        return FILE_UNSOLVED;
+
+    PagedFile solution;
+    if (!solution.open(out.fd, m.size, true, pageBytes, pages) || !markPath(m, solution, state))
+        return FILE_ERROR;
+    return FILE_SOLVED;
+}
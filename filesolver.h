@@ -0,0 +1,32 @@
+#ifndef FILESOLVER_H
+#define FILESOLVER_H
+
+#include <cstddef>
+
+using namespace std;
+
+// Outcomes of solveFile().
+enum FileSolveResult
+{
+    FILE_SOLVED,   // The solution was written to the output file
+    FILE_UNSOLVED, // The maze has no exits or no path; it was copied as is
+    FILE_ERROR     // A file could not be read, written or mapped
+};
+
+// Resident memory solveFile() aims for when none is given.
+const size_t DEFAULT_FILE_BUDGET = (size_t)256 << 20;
+
+// Solves the maze stored in the file inPath and writes the solved
+// maze to outPath, for mazes too large to hold in memory.
+//
+// The maze is never loaded whole. It is read through windowed memory
+// maps, the per-cell search state (one byte: settled flag and the
+// direction of the parent) lives in a temporary file next to outPath,
+// and the path is marked straight into outPath. Together the mapped
+// windows stay within memoryBudget bytes (at least a few system pages
+// per file); the search frontier is held in memory on top of that
+// and grows with the width of the search front, not the maze size.
+FileSolveResult solveFile(const char *inPath, const char *outPath);
+FileSolveResult solveFile(const char *inPath, const char *outPath, size_t memoryBudget);
+
+#endif
@@ -0,0 +1,294 @@
+#include <algorithm>
+#include <climits>
+#include <limits>
+#include "cellstate.h"
+#include "gridsearch.h"
+#include "portalheuristic.h"
+
+using namespace std;
+
+static const int UNSEEN = INT_MAX;
+
+// Helper function: implicitDijkstra with costs of type Cost, whose
+// largest value means unseen. costSoFar has one entry per offset.
+template <typename Cost>
+static bool implicitSearch(const MazeGrid &grid, const MazeScan &scan, SearchScratch &s, Cost *costSoFar) {
+    const Cost UNREACHED = numeric_limits<Cost>::max();
+    const char *maze = grid.data;
+    size_t cells = (size_t)grid.rows * grid.stride;
+    uint32_t stride = grid.stride;
+    fill(costSoFar, costSoFar + cells, UNREACHED);
+    s.parentCodes.resize(parentCodeBytes(cells));
+    uint8_t *codes = s.parentCodes.data();
+    s.settled.assign((cells + 63) / 64, 0);
+    uint64_t *settled = s.settled.data();
+    BucketQueue<uint32_t> &frontier = s.buckets;
+    frontier.clear();
+    frontier.push(scan.start, 0);
+    s.counters.push(1);
+    costSoFar[scan.start] = 0;
+
+    while (frontier.size() > 0) {
+        int currentCost = frontier.frontPriority();
+        uint32_t current = frontier.front();
+        frontier.pop();
+        s.counters.pop();
+
+        // Skip entries left behind by a later, cheaper push.
+        uint64_t bit = 1ull << (current % 64);
+        if (settled[current / 64] & bit)
+            continue;
+        settled[current / 64] |= bit;
+        s.counters.settle();
+
+        if (current == scan.goal)
+            return true;
+
+        // Neighbors in the same order as the graph: up, down, left,
+        // right, then the portal jump. The newline that ends each row
+        // stops left and right moves from wrapping around.
+        uint32_t next[5];
+        int weight[5];
+        ParentCode code[5];
+        int count = 0;
+        if (current >= stride)
+            next[count] = current - stride, code[count] = FROM_DOWN, weight[count++] = 1;
+        if (current + stride < cells)
+            next[count] = current + stride, code[count] = FROM_UP, weight[count++] = 1;
+        if (current > 0)
+            next[count] = current - 1, code[count] = FROM_RIGHT, weight[count++] = 1;
+        next[count] = current + 1, code[count] = FROM_LEFT, weight[count++] = 1;
+        char ch = maze[current];
+        if (ch >= '0' && ch <= '9') {
+            const uint32_t *ends = scan.ends[ch - '0'];
+            if (ends[0] != MazeScan::NONE) {
+                next[count] = ends[0] == current ? ends[1] : ends[0];
+                code[count] = FROM_PORTAL;
+                weight[count++] = ch - '0';
+            }
+        }
+
+        for (int i = 0; i < count; i++) {
+            char nc = maze[next[i]];
+            if (nc == '#' || nc == '\n')
+                continue;
+            int newCost = currentCost + weight[i];
+            if (newCost < costSoFar[next[i]]) {
+                costSoFar[next[i]] = newCost;
+                setParentCode(codes, next[i], code[i]);
+                frontier.push(next[i], newCost);
+                s.counters.push(frontier.size());
+            }
+        }
+    }
+    return false;
+}
+
+bool implicitDijkstra(const MazeGrid &grid, const MazeScan &scan, SearchScratch &s) {
+    size_t cells = (size_t)grid.rows * grid.stride;
+    if (fitsNarrow(cells)) {
+        s.narrowCost.resize(cells);
+        return implicitSearch(grid, scan, s, s.narrowCost.data());
+    }
+    s.costSoFar.resize(cells);
+    return implicitSearch(grid, scan, s, s.costSoFar.data());
+}
+
+int implicitCost(const MazeGrid &grid, const SearchScratch &s, uint32_t cell) {
+    if (fitsNarrow((size_t)grid.rows * grid.stride))
+        return s.narrowCost[cell] == numeric_limits<uint16_t>::max() ? -1 : s.narrowCost[cell];
+    return s.costSoFar[cell] == numeric_limits<int>::max() ? -1 : s.costSoFar[cell];
+}
+
+// Move directions for jumpPointSearch. ORIGIN marks the start and
+// cells entered through a portal, which are expanded every way.
+enum { UP, DOWN, LEFT, RIGHT, ORIGIN };
+
+// Helper class: the straight-line jumps of jumpPointSearch.
+class Jumper
+{
+    public:
+        Jumper(const MazeGrid &grid, const MazeScan &scan) :
+            maze(grid.data), cells((size_t)grid.rows * grid.stride),
+            stride(grid.stride), goal(scan.goal), scan(scan)
+        {
+        }
+
+        // Whether a cell can be stood on; the newline ending each row
+        // and anything outside the maze count as walls.
+        bool open(int64_t cell) const
+        {
+            return cell >= 0 && (size_t)cell < cells && maze[cell] != '#' && maze[cell] != '\n';
+        }
+
+        bool portal(uint32_t cell) const
+        {
+            char ch = maze[cell];
+            return ch >= '0' && ch <= '9' && scan.ends[ch - '0'][0] != MazeScan::NONE;
+        }
+
+        // The cell's forced vertical neighbors when entered moving
+        // horizontally by step (+1 or -1), as bits of UP and DOWN.
+        int forced(uint32_t cell, int step) const
+        {
+            int dirs = 0;
+            if (open((int64_t)cell - stride) && !open((int64_t)cell - stride - step))
+                dirs |= 1 << UP;
+            if (open((int64_t)cell + stride) && !open((int64_t)cell + stride - step))
+                dirs |= 1 << DOWN;
+            return dirs;
+        }
+
+        // Runs from cell by step (+1 or -1) until a jump point, which it
+        // returns with the number of steps; NONE on hitting a wall.
+        uint32_t horizontal(uint32_t cell, int step, int &steps) const
+        {
+            for (int64_t x = cell + step, n = 1; open(x); x += step, n++) {
+                if (x == goal || portal(x) || forced(x, step)) {
+                    steps = n;
+                    return x;
+                }
+            }
+            return MazeScan::NONE;
+        }
+
+        // Same, by step (+stride or -stride), stopping also where a
+        // horizontal jump would find a jump point.
+        uint32_t vertical(uint32_t cell, int64_t step, int &steps) const
+        {
+            int ignored;
+            for (int64_t x = cell + step, n = 1; open(x); x += step, n++) {
+                if (x == goal || portal(x) ||
+                    horizontal(x, -1, ignored) != MazeScan::NONE ||
+                    horizontal(x, 1, ignored) != MazeScan::NONE) {
+                    steps = n;
+                    return x;
+                }
+            }
+            return MazeScan::NONE;
+        }
+
+    private:
+        const char *maze;
+        size_t cells;
+        int64_t stride;
+        uint32_t goal;
+        const MazeScan &scan;
+};
+
+bool jumpPointSearch(const MazeGrid &grid, const MazeScan &scan, SearchScratch &s) {
+    const char *maze = grid.data;
+    size_t cells = (size_t)grid.rows * grid.stride;
+    uint32_t stride = grid.stride;
+    Jumper jump(grid, scan);
+    PortalHeuristic estimate(scan.goal / stride, scan.goal % stride);
+    for (const PortalPair &p : scan.portals)
+        estimate.addPortal(p.a / stride, p.a % stride, p.b / stride, p.b % stride, p.cost);
+    auto h = [&](uint32_t cell) { return estimate(cell / stride, cell % stride); };
+
+    pmr::vector<int> &costSoFar = s.costSoFar;
+    pmr::vector<uint32_t> &parent = s.parent;
+    pmr::vector<uint8_t> &arrived = s.arrived;   // Directions reached at the best cost; the move from the parent in bits 5-7
+    pmr::vector<uint8_t> &expanded = s.expanded; // Directions already expanded
+    costSoFar.assign(cells, UNSEEN);
+    parent.assign(cells, MazeScan::NONE);
+    arrived.assign(cells, 0);
+    expanded.assign(cells, 0);
+    MinPriorityQueue<uint32_t, 4> &frontier = s.heap;
+    frontier.clear();
+    frontier.reserve(cells);
+    costSoFar[scan.start] = 0;
+    arrived[scan.start] = 1 << ORIGIN | ORIGIN << 5;
+    frontier.push(scan.start, h(scan.start));
+    s.counters.push(1);
+
+    // Helper: offers next, reached from current by a move in dir.
+    auto reach = [&](uint32_t current, uint32_t next, int cost, int dir) {
+        if (cost < costSoFar[next]) {
+            bool queued = costSoFar[next] != UNSEEN && frontier.contains(next);
+            costSoFar[next] = cost;
+            parent[next] = current;
+            arrived[next] = 1 << dir | dir << 5;
+            expanded[next] = 0;
+            if (queued) {
+                frontier.decrease_key(next, cost + h(next));
+                s.counters.decreaseKey();
+            } else {
+                frontier.push(next, cost + h(next));
+                s.counters.push(frontier.size());
+            }
+        } else if (cost == costSoFar[next] && !(arrived[next] & 1 << dir)) {
+            // A tie from a new direction opens moves the first arrival pruned.
+            arrived[next] |= 1 << dir;
+            if (!frontier.contains(next)) {
+                frontier.push(next, cost + h(next));
+                s.counters.push(frontier.size());
+            }
+        }
+    };
+
+    bool found = false;
+    while (frontier.size() > 0) {
+        uint32_t current = frontier.front();
+        frontier.pop();
+        s.counters.pop();
+        int currentCost = costSoFar[current];
+        if (current == scan.goal) {
+            found = true;
+            break;
+        }
+
+        // Moves allowed after each arrival direction: straight on, plus
+        // either way after a vertical move or the forced neighbors after
+        // a horizontal one. Portal cells and the start go every way.
+        int fresh = arrived[current] & 0x1F & ~expanded[current];
+        if (!expanded[current])
+            s.counters.settle();
+        expanded[current] |= fresh;
+        int dirs = 0;
+        if (fresh & 1 << ORIGIN || jump.portal(current))
+            dirs = 1 << UP | 1 << DOWN | 1 << LEFT | 1 << RIGHT;
+        if (fresh & 1 << UP)
+            dirs |= 1 << UP | 1 << LEFT | 1 << RIGHT;
+        if (fresh & 1 << DOWN)
+            dirs |= 1 << DOWN | 1 << LEFT | 1 << RIGHT;
+        if (fresh & 1 << LEFT)
+            dirs |= 1 << LEFT | jump.forced(current, -1);
+        if (fresh & 1 << RIGHT)
+            dirs |= 1 << RIGHT | jump.forced(current, 1);
+
+        int steps = 0;
+        uint32_t next;
+        if (dirs & 1 << UP && (next = jump.vertical(current, -(int64_t)stride, steps)) != MazeScan::NONE)
+            reach(current, next, currentCost + steps, UP);
+        if (dirs & 1 << DOWN && (next = jump.vertical(current, stride, steps)) != MazeScan::NONE)
+            reach(current, next, currentCost + steps, DOWN);
+        if (dirs & 1 << LEFT && (next = jump.horizontal(current, -1, steps)) != MazeScan::NONE)
+            reach(current, next, currentCost + steps, LEFT);
+        if (dirs & 1 << RIGHT && (next = jump.horizontal(current, 1, steps)) != MazeScan::NONE)
+            reach(current, next, currentCost + steps, RIGHT);
+
+        // The portal jump, once, when the cell is first expanded.
+        char ch = maze[current];
+        if (fresh == (arrived[current] & 0x1F) && jump.portal(current)) {
+            const uint32_t *ends = scan.ends[ch - '0'];
+            reach(current, ends[0] == current ? ends[1] : ends[0], currentCost + (ch - '0'), ORIGIN);
+        }
+    }
+    if (!found)
+        return false;
+
+    // Fill in the cells each straight jump skipped, so parents step
+    // one cell at a time like the other searches'.
+    for (uint32_t cur = scan.goal; cur != scan.start;) {
+        uint32_t from = parent[cur];
+        int dir = arrived[cur] >> 5;
+        if (dir != ORIGIN) {
+            int64_t back = dir == UP ? stride : dir == DOWN ? -(int64_t)stride : dir == LEFT ? 1 : -1;
+            for (uint32_t x = cur; x != from; x += back)
+                parent[x] = x + back;
+        }
+        cur = from;
+    }
+    return true;
+}
@@ -0,0 +1,52 @@
+#ifndef GRIDSEARCH_H
+#define GRIDSEARCH_H
+
+#include "mazegrid.h"
+#include "mazescan.h"
+#include "search.h"
+
+using namespace std;
+
+// Shortest-path searches that work on the maze bytes themselves,
+// without building a graph first.
+//
+// Cells are named by their offset in the maze string, as in MazeScan.
+// Each search returns whether scan.goal was reached.
+
+// Dijkstra's algorithm with a BucketQueue on the implicit grid graph.
+// The up/down/left/right neighbors of a cell are read from the bytes
+// around it; portal jumps come from the scan's portal table.
+//
+// The per-cell state is dense and packed: costs in s.narrowCost when
+// fitsNarrow() and s.costSoFar otherwise, a bit per settled cell in
+// s.settled, and the move that reached each cell in s.parentCodes, four bits
+// per cell, in place of a parent. Walk the path back with markParents().
+//
+// Runs in O(s) time.
+bool implicitDijkstra(const MazeGrid &grid, const MazeScan &scan, SearchScratch &s);
+
+// The cost implicitDijkstra() last found to cell, or -1 if it did not
+// reach it. With scan.goal set to MazeScan::NONE the search runs until
+// it has settled every cell it can reach, and the parent codes form a
+// shortest-path tree from scan.start.
+int implicitCost(const MazeGrid &grid, const SearchScratch &s, uint32_t cell);
+
+// Jump point search: A* with the portal-aware heuristic over jump
+// points instead of every cell.
+//
+// Straight runs are skipped without touching the queue. Paths are
+// taken in a canonical form that turns from vertical to horizontal
+// anywhere but from horizontal to vertical only at a forced neighbor,
+// a cell beside the run whose cell one step back is blocked. A
+// horizontal jump stops at a forced neighbor; a vertical jump stops
+// where a horizontal jump from it would stop. The goal and every
+// portal cell are jump points, and portal cells are expanded in all
+// directions plus the portal. A cell reached at the same cost from
+// several directions is expanded for each of them.
+//
+// Fills s.parent with the predecessor of every cell on the path, one
+// cell at a time along straight segments too, up to the start, whose
+// parent is MazeScan::NONE.
+bool jumpPointSearch(const MazeGrid &grid, const MazeScan &scan, SearchScratch &s);
+
+#endif
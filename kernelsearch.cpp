@@ -0,0 +1,258 @@
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include "bitsearch.h"
+#include "cellstate.h"
+#include "kernelsearch.h"
+
+using namespace std;
+
+static const int SMALL_SIDE = 64;
+static const size_t SMALL_CELLS = SMALL_SIDE * (SMALL_SIDE + 1); // Offsets of a small maze, newlines included
+
+MazeProfile profileMaze(const MazeGrid &grid, const MazeScan &scan) {
+    MazeProfile profile;
+    profile.portals = !scan.portals.empty();
+    profile.small = grid.rows <= SMALL_SIDE && grid.cols <= SMALL_SIDE;
+    profile.narrowIds = fitsNarrow((size_t)grid.rows * grid.stride);
+    return profile;
+}
+
+// Helper function: breadth-first search on a small maze without
+// portals. Each row is one word, so the frontier, the unseen cells and
+// the level bits (mod 3, as in bitParallelBfs) are arrays of at most
+// 64 words on the stack, and one more word marks the rows the frontier
+// is in. A level is a few shifts for each of those rows and the rows
+// beside them.
+static bool smallBfs(const MazeGrid &grid, const MazeScan &scan, SearchScratch &s, PathOut out) {
+    int rows = grid.rows;
+    uint64_t unseen[SMALL_SIDE], level0[SMALL_SIDE], level1[SMALL_SIDE];
+    uint64_t next[SMALL_SIDE];
+    uint64_t frontRows[SMALL_SIDE + 2]; // Zero rows above and below spare the edge checks
+    uint64_t *front = frontRows + 1;
+    for (int r = 0; r < rows; r++) {
+        unseen[r] = ~scan.walls[r];
+        level0[r] = level1[r] = 0;
+    }
+    fill(frontRows, frontRows + rows + 2, 0);
+    int startRow = scan.start / grid.stride;
+    int goalRow = scan.goal / grid.stride;
+    uint64_t startBit = 1ull << (scan.start % grid.stride);
+    uint64_t goalBit = 1ull << (scan.goal % grid.stride);
+    front[startRow] = startBit;
+    unseen[startRow] &= ~startBit;
+    s.counters.push(1);
+
+    // Bit r of active is set when row r holds frontier cells; rows
+    // outside it are all zero in front.
+    uint64_t allRows = rows == SMALL_SIDE ? ~0ull : (1ull << rows) - 1;
+    uint64_t active = 1ull << startRow;
+    int depth = 0;
+    while (unseen[goalRow] & goalBit) {
+        depth++;
+        uint64_t mask0 = depth % 3 == 1 ? ~0ull : 0;
+        uint64_t mask1 = depth % 3 == 2 ? ~0ull : 0;
+        uint64_t touched = (active | active << 1 | active >> 1) & allRows;
+        active = 0;
+        for (uint64_t bits = touched; bits; bits &= bits - 1) {
+            int r = __builtin_ctzll(bits);
+            uint64_t f = front[r];
+            uint64_t reach = (f << 1 | f >> 1 | front[r - 1] | front[r + 1]) & unseen[r];
+            next[r] = reach;
+            s.counters.pop(__builtin_popcountll(f));
+            s.counters.settle(__builtin_popcountll(f));
+            if (!reach)
+                continue;
+            unseen[r] &= ~reach;
+            level0[r] |= reach & mask0;
+            level1[r] |= reach & mask1;
+            active |= 1ull << r;
+        }
+        if (!active)
+            return false;
+        for (uint64_t bits = touched; bits; bits &= bits - 1) {
+            int r = __builtin_ctzll(bits);
+            front[r] = next[r];
+        }
+
+        if (SearchCounters::enabled) {
+            size_t cells = 0;
+            for (int r = 0; r < rows; r++)
+                cells += __builtin_popcountll(front[r]);
+            s.counters.push(cells, cells);
+        }
+    }
+
+    // Walk back from the goal, each step to a reached neighbor one
+    // level lower, trying up, down, left, right in turn.
+    auto levelIs = [&](int r, int c, int mod) {
+        if (r < 0 || r >= rows || c < 0 || c >= grid.cols)
+            return false;
+        uint64_t bit = 1ull << c;
+        if ((scan.walls[r] | unseen[r]) & bit)
+            return false;
+        return ((level0[r] & bit ? 1 : 0) | (level1[r] & bit ? 2 : 0)) == mod;
+    };
+    const int dr[4] = {-1, 1, 0, 0};
+    const int dc[4] = {0, 0, -1, 1};
+    int r = goalRow, c = scan.goal % grid.stride;
+    out.add(scan.goal);
+    s.counters.pathCell();
+    for (int k = depth; k > 0; k--) {
+        int mod = (k - 1) % 3;
+        int d = 0;
+        while (!levelIs(r + dr[d], c + dc[d], mod))
+            d++;
+        r += dr[d];
+        c += dc[d];
+        out.add(grid.offset(r, c));
+        s.counters.pathCell();
+    }
+    return true;
+}
+
+// Helper function: Dijkstra over cell offsets with Dial's buckets.
+// No move costs more than 9, so ten buckets of cost mod 10 hold every
+// waiting cell. Each bucket is an intrusive doubly linked list through
+// prev and next, so a cheaper path moves a cell with an unlink and a
+// link instead of a second entry, and nothing is ever skipped as stale.
+//
+// Id is the offset type and Cost the cost type; the largest value of
+// each means none, so offsets and costs must be smaller. cost, prev and
+// next have one entry per offset, codes holds a packed ParentCode per
+// offset,
+// and none of them needs clearing.
+template <typename Id, typename Cost>
+static bool dialSearch(const MazeGrid &grid, const MazeScan &scan, SearchScratch &s,
+                       Cost *cost, uint8_t *codes, Id *prev, Id *next, PathOut out) {
+    const Id NONE = numeric_limits<Id>::max();
+    const Cost UNSEEN = numeric_limits<Cost>::max();
+    const char *maze = grid.data;
+    size_t cells = (size_t)grid.rows * grid.stride;
+    Id stride = grid.stride;
+    fill(cost, cost + cells, UNSEEN);
+    Id head[10];
+    fill(head, head + 10, NONE);
+
+    auto link = [&](Id v, int c) {
+        Id &first = head[c % 10];
+        prev[v] = NONE;
+        next[v] = first;
+        if (first != NONE)
+            prev[first] = v;
+        first = v;
+    };
+    auto unlink = [&](Id v, int c) {
+        if (prev[v] != NONE)
+            next[prev[v]] = next[v];
+        else
+            head[c % 10] = next[v];
+        if (next[v] != NONE)
+            prev[next[v]] = prev[v];
+    };
+
+    Id start = scan.start, goal = scan.goal;
+    cost[start] = 0;
+    link(start, 0);
+    size_t queued = 1;
+    s.counters.push(1);
+
+    for (int current = 0; queued > 0; current++) {
+        Id &bucket = head[current % 10];
+        while (bucket != NONE) {
+            Id v = bucket;
+            unlink(v, current);
+            queued--;
+            s.counters.pop();
+            s.counters.settle();
+
+            if (v == goal) {
+                s.counters.pathCell(markParents(grid, scan, codes, out));
+                return true;
+            }
+
+            // Neighbors in the same order as implicitDijkstra's.
+            Id adjacent[5];
+            int weight[5];
+            ParentCode code[5];
+            int count = 0;
+            if (v >= stride)
+                adjacent[count] = v - stride, code[count] = FROM_DOWN, weight[count++] = 1;
+            if (v + stride < cells)
+                adjacent[count] = v + stride, code[count] = FROM_UP, weight[count++] = 1;
+            if (v > 0)
+                adjacent[count] = v - 1, code[count] = FROM_RIGHT, weight[count++] = 1;
+            adjacent[count] = v + 1, code[count] = FROM_LEFT, weight[count++] = 1;
+            char ch = maze[v];
+            if (ch >= '0' && ch <= '9') {
+                const uint32_t *ends = scan.ends[ch - '0'];
+                if (ends[0] != MazeScan::NONE) {
+                    adjacent[count] = ends[0] == v ? ends[1] : ends[0];
+                    code[count] = FROM_PORTAL;
+                    weight[count++] = ch - '0';
+                }
+            }
+
+            for (int i = 0; i < count; i++) {
+                Id n = adjacent[i];
+                char nc = maze[n];
+                if (nc == '#' || nc == '\n')
+                    continue;
+                int newCost = current + weight[i];
+                if (newCost >= cost[n])
+                    continue;
+                if (cost[n] == UNSEEN) {
+                    queued++;
+                    s.counters.push(queued);
+                } else {
+                    unlink(n, cost[n]);
+                    s.counters.decreaseKey();
+                }
+                cost[n] = newCost;
+                setParentCode(codes, n, code[i]);
+                link(n, newCost);
+            }
+        }
+    }
+    return false;
+}
+
+bool kernelSearch(const MazeGrid &grid, const MazeScan &scan, SearchScratch &s, PathOut out) {
+    MazeProfile profile = profileMaze(grid, scan);
+    size_t cells = (size_t)grid.rows * grid.stride;
+
+    if (!profile.portals) {
+        if (profile.small)
+            return smallBfs(grid, scan, s, out);
+        if (!bitParallelBfs(grid, scan, s))
+            return false;
+        for (uint32_t cur = scan.goal; cur != MazeScan::NONE; cur = s.parent[cur]) {
+            out.add(cur);
+            s.counters.pathCell();
+            if (cur == scan.start)
+                break;
+        }
+        return true;
+    }
+
+    if (profile.small) {
+        uint16_t cost[SMALL_CELLS];
+        uint8_t codes[SMALL_CELLS / 2];
+        uint16_t links[2 * SMALL_CELLS];
+        return dialSearch<uint16_t, uint16_t>(grid, scan, s, cost, codes, links,
+                                              links + SMALL_CELLS, out);
+    }
+    s.parentCodes.resize(parentCodeBytes(cells));
+    if (profile.narrowIds) {
+        s.narrowCost.resize(cells);
+        s.narrowLinks.resize(2 * cells);
+        uint16_t *links = s.narrowLinks.data();
+        return dialSearch<uint16_t, uint16_t>(grid, scan, s, s.narrowCost.data(), s.parentCodes.data(),
+                                              links, links + cells, out);
+    }
+    s.costSoFar.resize(cells);
+    s.wideLinks.resize(2 * cells);
+    uint32_t *links = s.wideLinks.data();
+    return dialSearch<uint32_t, int>(grid, scan, s, s.costSoFar.data(), s.parentCodes.data(),
+                                     links, links + cells, out);
+}
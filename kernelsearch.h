@@ -0,0 +1,40 @@
+#ifndef KERNELSEARCH_H
+#define KERNELSEARCH_H
+
+#include "mazegrid.h"
+#include "mazescan.h"
+#include "pathout.h"
+#include "search.h"
+
+using namespace std;
+
+// What the kernel dispatch looks at, all of it read off the scan.
+struct MazeProfile
+{
+    bool portals;   // Some move costs other than 1
+    bool small;     // At most 64 rows of at most 64 columns
+    bool narrowIds; // Every cell offset and path cost fits in 16 bits
+};
+
+MazeProfile profileMaze(const MazeGrid &grid, const MazeScan &scan);
+
+// Solves with a search specialized at compile time for the maze's
+// profile, and puts the path in out, which, if it marks a solution,
+// must already hold the maze:
+//
+// - Without portals, breadth-first search on bitboards: for a small
+//   maze one word per row in arrays on the stack, otherwise
+//   bitParallelBfs.
+// - With portals, Dijkstra with Dial's buckets over cell offsets,
+//   with 16-bit offsets, costs and links when they fit and a 4-bit
+//   ParentCode per cell in place of a parent; a small maze keeps all of
+//   it on the stack.
+//
+// The small kernels allocate nothing and carry no checks for the cases
+// they rule out, which is most of the cost of a tiny maze.
+// Returns whether a path was found.
+//
+// Runs in O(s) time.
+bool kernelSearch(const MazeGrid &grid, const MazeScan &scan, SearchScratch &s, PathOut out);
+
+#endif
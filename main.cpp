@@ -1,8 +1,24 @@
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <memory_resource>
+#include <cstdio>
+#include <cstddef>
 #include <cstdlib>
+#include <cstring>
 #include <string>
+#include "batchsolver.h"
+#include "dynamicsolver.h"
+#include "filesolver.h"
+#include "mazegen.h"
+#include "mazeindex.h"
+#include "mazeroute.h"
+#include "packedmaze.h"
+#include "parallelsearch.h"
 #include "solve.h"
+#include "solvecache.h"
+#include "tiledmaze.h"
 
 using namespace std;
 
@@ -21,6 +37,7 @@ int main()
 	// Setup
 	srand(2025 + 's');
 	string maze, soln;
+	SolveEngine engines[] = { ENGINE_HEAP, ENGINE_BUCKET, ENGINE_ASTAR, ENGINE_IMPLICIT, ENGINE_PARALLEL, ENGINE_BITBFS, ENGINE_JPS, ENGINE_AUTO, ENGINE_CORRIDOR };
 
 
 	// Test a few mazes without portals
@@ -498,6 +515,11 @@ int main()
 	soln += "#  # #       # ##         ooooooooooooo#\n";
 	soln += "######################################o#\n";
 	test(solve(maze) == soln);
+	for (SolveEngine engine : engines)
+		test(solve(maze, engine) == soln);
+	string marked = maze;
+	test(solveInto(marked, &marked[0]));
+	test(marked == soln);
 
 	for (int t = 0; t < 100; ++t)
 	{
@@ -546,6 +568,534 @@ int main()
 		test(solve(maze) == soln);
 	}
 
+	// Test repeated queries between the exits of an indexed maze
+
+	maze = "";
+	maze += "### ##########\n";
+	maze += "# 3        3 #\n";
+	maze += "# ########## #\n";
+	maze += "              \n";
+	maze += "# ########## #\n";
+	maze += "#  0      0  #\n";
+	maze += "######## #####\n";
+	MazeIndex index(maze, 4);
+	test(index.exits().size() == 4);
+	test(index.distance(3, 0, 3, 13) == 10);
+	test(index.distance(3, 13, 3, 0) == 10);
+	test(index.distance(0, 3, 6, 8) == 12);
+	test(index.distance(0, 0, 6, 8) == -1);
+	soln = maze;
+	soln[3 * 15] = '#';
+	soln[3 * 15 + 13] = '#';
+	soln = solve(soln);
+	soln[3 * 15] = ' ';
+	soln[3 * 15 + 13] = ' ';
+	test(index.solve(0, 3, 6, 8) == soln);
+	test(index.distance(1, 2, 5, 3) == 7);
+	test(index.distance(1, 1, 3, 0) == 3);
+
+	// The same queries answered by search, from cells without trees
+	MazeIndex searched(maze, 1);
+	test(searched.distance(3, 0, 3, 13) == 10);
+	test(searched.distance(6, 8, 0, 3) == 12);
+	test(searched.distance(1, 2, 5, 3) == 7);
+	test(searched.solve(0, 3, 6, 8) == soln);
+	test(searched.solve(6, 8, 0, 3) == soln);
+	test(index.searches() == 1 && searched.searches() == 2);
+
+	// By default a small maze gives every exit a tree, so no query
+	// between exits searches
+	MazeIndex everyExit(maze);
+	test(everyExit.treeCount() == everyExit.exits().size());
+	for (const pair<int, int> &from : everyExit.exits())
+		for (const pair<int, int> &to : everyExit.exits())
+			test(everyExit.distance(from.first, from.second, to.first, to.second) == index.distance(from.first, from.second, to.first, to.second));
+	test(everyExit.searches() == 0);
+
+	// Test re-solving a maze while cells change
+
+	maze = "";
+	maze += "# #####\n";
+	maze += "#     #\n";
+	maze += "##### #\n";
+	maze += "#     #\n";
+	maze += "# #####\n";
+	DynamicMazeSolver dynamic(maze);
+	test(dynamic.cost() == 12);
+	test(dynamic.solve() == solve(maze));
+	test(dynamic.update(2, 1, ' '));
+	test(dynamic.cost() == 4);
+	test(dynamic.solve() == solve(dynamic.maze()));
+	test(dynamic.update(2, 1, '#'));
+	test(dynamic.update(1, 2, '3'));
+	test(dynamic.update(3, 2, '3'));
+	test(dynamic.cost() == 7);
+	test(dynamic.solve() == solve(dynamic.maze()));
+	test(dynamic.update(3, 2, ' '));
+	test(dynamic.cost() == 12);
+	test(dynamic.update(0, 1, '#'));
+	test(dynamic.cost() == -1);
+	test(dynamic.solve() == dynamic.maze());
+	test(!dynamic.update(5, 0, ' '));
+
+	// Test solving through tiles, before and after cells change
+
+	maze = generateMaze(MAZE_PERFECT, 41, 60, 7);
+	TiledMaze tiled(maze, 8);
+	test(tiled.tileRows() == 6 && tiled.tileCols() == 8);
+	test(tiled.solve() == solve(maze));
+	maze = generateMaze(MAZE_PORTALS, 41, 60, 7);
+	TiledMaze tiledPortals(maze, 8);
+	DynamicMazeSolver dynamicPortals(maze);
+
+	// The two may mark different paths of the same cost, so compare
+	// the cost of walking each one: the maze with every unmarked cell
+	// walled off.
+	auto markedCost = [](string maze, const string &solution)
+	{
+		for (size_t i = 0; i < maze.size(); ++i)
+		{
+			if (maze[i] != '\n' && solution[i] != 'o')
+				maze[i] = '#';
+		}
+		return DynamicMazeSolver(maze).cost();
+	};
+	int solvable = 0;
+	for (int i = 0; i <= 40; ++i)
+	{
+		if (i > 0)
+		{
+			int r = 1 + i * 7 % 39, c = 1 + i * 13 % 58;
+			char ch = i % 3 ? ' ' : '#';
+			test(tiledPortals.update(r, c, ch));
+			test(dynamicPortals.update(r, c, ch));
+		}
+		int tiledCost = tiledPortals.cost();
+		test(tiledCost == dynamicPortals.cost());
+		if (tiledCost < 0)
+			continue;
+		test(markedCost(tiledPortals.maze(), tiledPortals.solve()) == tiledCost);
+		test(markedCost(dynamicPortals.maze(), dynamicPortals.solve()) == tiledCost);
+		++solvable;
+	}
+	test(solvable > 10);
+	test(!tiledPortals.update(41, 0, ' '));
+	maze = generateMaze(MAZE_ROOMS, 70, 90, 7);
+	TiledMaze tiledRooms(maze, 16);
+	soln = solve(maze);
+	test(tiledRooms.cost() == markedCost(maze, soln));
+	test(markedCost(maze, tiledRooms.solve()) == tiledRooms.cost());
+
+	// Test solving a batch of mazes on several threads
+
+	vector<string> batch;
+	for (int t = 0; t < 50; ++t)
+	{
+		maze = "";
+		maze += "######\n";
+		maze += " 1  1 \n";
+		maze += "######\n";
+		maze[8 + t % 4] = '#';
+		batch.push_back(maze);
+	}
+	vector<string_view> views(batch.begin(), batch.end());
+	BatchSolver batchSolver(4);
+	for (SolveEngine engine : engines)
+	{
+		vector<string> solved = batchSolver.solve(views, engine);
+		test(solved.size() == batch.size());
+		for (size_t i = 0; i < batch.size(); ++i)
+			test(solved[i] == solve(batch[i]));
+	}
+
+	// Test delta-stepping with wider buckets, on several threads
+
+	ThreadPool deltaPool(4);
+	atomic<size_t> chunked(0);
+	deltaPool.parallelFor(1000, 7, [&](size_t begin, size_t end, int worker)
+	{
+		test(end - begin <= 7 && worker >= 0 && worker < 4);
+		chunked += end - begin;
+	});
+	test(chunked == 1000);
+	for (int kind = MAZE_PERFECT; kind <= MAZE_PORTALS; ++kind)
+	{
+		MazeGraph deltaGraph;
+		buildMazeGraph(parseMaze(generateMaze((MazeKind)kind, 120, 90, 3)), deltaGraph);
+		SearchScratch deltaScratch;
+		auto pathCost = [&]()
+		{
+			int total = 0;
+			for (uint32_t v = deltaGraph.goal; v != deltaGraph.start; v = deltaScratch.parent[v])
+			{
+				uint32_t u = deltaScratch.parent[v];
+				for (uint32_t e = deltaGraph.offsets[u]; e < deltaGraph.offsets[u + 1]; ++e)
+				{
+					if (deltaGraph.targets[e] == v)
+					{
+						total += deltaGraph.weights[e];
+						break;
+					}
+				}
+			}
+			return total;
+		};
+		test(dijkstraBucket(deltaGraph, deltaScratch));
+		int bestCost = pathCost();
+		for (int delta : { 1, 2, 3, 10 })
+		{
+			test(deltaStepping(deltaGraph, deltaPool, deltaScratch, delta));
+			test(pathCost() == bestCost);
+		}
+	}
+
+	// Test answering mazes sent again from a cache of solutions
+
+	SolveCache cache(1 << 20, 4);
+	MazeSolver cachedSolver;
+	maze = generateMaze(MAZE_PORTALS, 41, 60, 7);
+	soln = string(maze.size(), '\0');
+	test(cache.solveInto(cachedSolver, maze, &soln[0], ENGINE_AUTO));
+	test(soln == solve(maze));
+	soln = maze;
+	test(cache.solveInto(cachedSolver, soln, &soln[0], ENGINE_AUTO));
+	test(soln == solve(maze));
+	soln = "#####\n#   #\n#####\n";
+	test(!cache.solveInto(cachedSolver, soln, &soln[0], ENGINE_AUTO));
+	test(!cache.solveInto(cachedSolver, soln, &soln[0], ENGINE_AUTO));
+	test(soln == "#####\n#   #\n#####\n");
+	SolveCacheStats cacheStats = cache.stats();
+	test(cacheStats.hits == 2 && cacheStats.misses == 2);
+	test(cacheStats.entries == 2 && cacheStats.evictions == 0);
+
+	SolveCache smallCache(8000, 1);
+	for (int kind = MAZE_PERFECT; kind <= MAZE_PORTALS; ++kind)
+	{
+		maze = generateMaze((MazeKind)kind, 41, 60, 7);
+		soln = solve(maze);
+		smallCache.insert(maze, soln.data(), true);
+	}
+	bool cachedFound = false;
+	test(smallCache.lookup(maze, &maze[0], cachedFound) && cachedFound);
+	test(maze == soln);
+	maze = generateMaze(MAZE_PERFECT, 41, 60, 7);
+	test(!smallCache.lookup(maze, &soln[0], cachedFound));
+	cacheStats = smallCache.stats();
+	test(cacheStats.evictions > 0 && cacheStats.bytes <= 8000);
+
+	// Test solving a maze file through small memory-mapped windows
+
+	const char *mazeFile = "solve_test_maze.txt";
+	const char *solnFile = "solve_test_soln.txt";
+	maze = "";
+	for (int r = 0; r <= 300; ++r)
+	{
+		// A serpentine whose walls open at alternating ends
+		string row(200, '#');
+		if (r % 2)
+			row = "#" + string(198, ' ') + "#";
+		else
+			row[r % 4 ? 198 : 1] = ' ';
+		maze += row + "\n";
+	}
+	FILE *f = fopen(mazeFile, "wb");
+	fwrite(maze.data(), 1, maze.size(), f);
+	fclose(f);
+	test(solveFile(mazeFile, solnFile, 64 << 10) == FILE_SOLVED);
+	f = fopen(solnFile, "rb");
+	soln = string(maze.size(), '\0');
+	test(fread(&soln[0], 1, soln.size(), f) == soln.size());
+	fclose(f);
+	test(soln != maze);
+	test(soln == solve(maze));
+	remove(mazeFile);
+	remove(solnFile);
+
+	// Test solving mazes loaded from packed files, with and without
+	// a prebuilt graph
+
+	const char *packedFile = "solve_test_maze.pak";
+	MazeSolver packedSolver;
+	MazeRoute packedRoute;
+	for (int kind = MAZE_PERFECT; kind <= MAZE_PORTALS; ++kind)
+	{
+		maze = generateMaze((MazeKind)kind, 41, 60, 7);
+		for (bool withGraph : { false, true })
+		{
+			test(writePackedMaze(packedFile, maze, withGraph));
+			PackedMaze packed;
+			test(packed.open(packedFile));
+			test(packed.hasGraph() == withGraph);
+			test(packed.header().rows == 41 && packed.header().cols == 60);
+			test(packed.text() == maze);
+			for (SolveEngine engine : engines)
+			{
+				soln = string(maze.size(), '\0');
+				test(packedSolver.solveInto(packed, &soln[0], engine));
+				test(soln == solve(maze, engine));
+				test(packedSolver.solveRoute(packed, packedRoute, engine));
+				test(packedRoute.cells.size() == (size_t)count(soln.begin(), soln.end(), 'o'));
+				for (uint32_t cell : packedRoute.cells)
+					soln[cell] = maze[cell];
+				test(soln == maze);
+			}
+		}
+	}
+	f = fopen(packedFile, "wb");
+	fwrite(maze.data(), 1, maze.size(), f);
+	fclose(f);
+	PackedMaze notPacked;
+	test(!notPacked.open(packedFile));
+	test(writePackedMaze(packedFile, maze, true));
+	string head(1000, '\0');
+	f = fopen(packedFile, "rb");
+	test(fread(&head[0], 1, head.size(), f) == head.size());
+	fclose(f);
+	f = fopen(packedFile, "wb");
+	fwrite(head.data(), 1, head.size(), f);
+	fclose(f);
+	test(!notPacked.open(packedFile));
+
+	// A file whose header names a cell that is not what it claims is
+	// rejected on open; one whose rows or graph would lead a search out
+	// of bounds is rejected by verify()
+	test(writePackedMaze(packedFile, maze, true));
+	test(notPacked.open(packedFile));
+	PackedMazeHeader packedHead = notPacked.header();
+	notPacked.close();
+	f = fopen(packedFile, "rb");
+	string packedBytes(packedHead.fileBytes, '\0');
+	test(fread(&packedBytes[0], 1, packedBytes.size(), f) == packedBytes.size());
+	fclose(f);
+	auto opensWith = [&](size_t at, const void *value, size_t n, bool verify)
+	{
+		string bad = packedBytes;
+		memcpy(&bad[at], value, n);
+		FILE *out = fopen(packedFile, "wb");
+		fwrite(bad.data(), 1, bad.size(), out);
+		fclose(out);
+		PackedMaze reopened;
+		return reopened.open(packedFile) && (!verify || reopened.verify());
+	};
+	int portal = 0;
+	while (packedHead.ends[portal][0] == MazeScan::NONE)
+		++portal;
+	uint32_t none = MazeScan::NONE;
+	uint32_t newline = packedHead.cols;
+	uint32_t wrongDigit = packedHead.ends[(portal + 1) % 10][0];
+	uint32_t tooBig = packedHead.vertices;
+	uint8_t heavy = 10;
+	size_t endAt = offsetof(PackedMazeHeader, ends) + (portal * 2 + 1) * 4;
+	size_t graphAt = packedHead.graphOffset;
+	size_t offsetsAt = graphAt + ((size_t)packedHead.vertices + packedHead.rows * packedHead.cols) * 4;
+	size_t targetsAt = offsetsAt + ((size_t)packedHead.vertices + 1) * 4;
+	size_t weightsAt = targetsAt + (size_t)packedHead.edges * 4;
+	test(opensWith(0, &packedHead, sizeof packedHead, true));
+	test(!opensWith(offsetof(PackedMazeHeader, start), &newline, 4, false));
+	test(!opensWith(offsetof(PackedMazeHeader, goal), &packedHead.start, 4, false));
+	test(!opensWith(endAt, &none, 4, false));
+	test(wrongDigit == MazeScan::NONE || !opensWith(endAt, &wrongDigit, 4, false));
+	test(!opensWith(offsetof(PackedMazeHeader, graphStart), &tooBig, 4, false));
+	test(!opensWith(offsetof(PackedMazeHeader, graphGoal), &tooBig, 4, false));
+	test(opensWith(packedHead.textOffset + packedHead.cols, "x", 1, false));
+	test(!opensWith(packedHead.textOffset + packedHead.cols, "x", 1, true));
+	test(!opensWith(targetsAt + 8, &tooBig, 4, true));
+	test(!opensWith(offsetsAt + 4, &packedHead.edges, 4, true));
+	tooBig = packedHead.edges + 1;
+	test(!opensWith(offsetsAt + (size_t)packedHead.vertices * 4, &tooBig, 4, true));
+	test(!opensWith(graphAt, &packedHead.vertices, 4, true));
+	test(!opensWith(weightsAt, &heavy, 1, true));
+	remove(packedFile);
+
+	// Test the route encodings on a maze whose path takes a portal
+
+	maze = "";
+	maze += "#### #####\n";
+	maze += "#1      ##\n";
+	maze += "######## #\n";
+	maze += "#1       #\n";
+	maze += "######## #\n";
+	MazeSolver routeSolver;
+	MazeRoute route;
+	test(routeSolver.solveRoute(maze, route, ENGINE_HEAP));
+	test(route.cells.size() == 14);
+	test(route.cells.front() == 4 && route.cells.back() == 52);
+	vector<MoveRun> moves = routeMoves(route);
+	test(encodeMoves(moves) == "D3LP7RD");
+	vector<MoveRun> decoded;
+	test(decodeMoves("D3LP7RD", decoded) && decoded.size() == moves.size());
+	test(decoded[2].move == MOVE_PORTAL && decoded[3].move == MOVE_RIGHT && decoded[3].count == 7);
+	test(!decodeMoves("3", decoded) && !decodeMoves("0R", decoded) && !decodeMoves("2X", decoded));
+	vector<CellRun> runs = routeRuns(route);
+	test(runs.size() == 4);
+	test(runs[0].row == 0 && runs[0].col == 4 && runs[0].endRow == 1 && runs[0].endCol == 4);
+	test(runs[1].row == 1 && runs[1].col == 3 && runs[1].endRow == 1 && runs[1].endCol == 1);
+	test(runs[2].row == 3 && runs[2].col == 1 && runs[2].endRow == 3 && runs[2].endCol == 8);
+	test(runs[3].row == 4 && runs[3].col == 8 && runs[3].endRow == 4 && runs[3].endCol == 8);
+
+	maze[4] = '#';
+	test(!routeSolver.solveRoute(maze, route, ENGINE_HEAP));
+	test(route.cells.empty() && routeMoves(route).empty() && routeRuns(route).empty());
+
+	// Test that routes match the solved mazes, and that streaming a
+	// route over the maze writes the solution, over several blocks for
+	// the larger maze
+
+	const char *routeFile = "solve_test_route.txt";
+	for (int kind = MAZE_PERFECT; kind <= MAZE_PORTALS + 1; ++kind)
+	{
+		if (kind <= MAZE_PORTALS)
+			maze = generateMaze((MazeKind)kind, 41, 60, 7);
+		else
+			maze = generateMaze(MAZE_PORTALS, 501, 400, 3);
+		for (SolveEngine engine : engines)
+		{
+			soln = solve(maze, engine);
+			test(routeSolver.solveRoute(maze, route, engine));
+			test(route.cells.size() == (size_t)count(soln.begin(), soln.end(), 'o'));
+			moves = routeMoves(route);
+			test(decodeMoves(encodeMoves(moves), decoded));
+			size_t steps = 0, cells = 0;
+			for (size_t i = 0; i < moves.size(); ++i)
+			{
+				test(decoded[i].move == moves[i].move && decoded[i].count == moves[i].count);
+				steps += moves[i].count;
+			}
+			for (const CellRun &run : routeRuns(route))
+				cells += abs(run.endRow - run.row) + abs(run.endCol - run.col) + 1;
+			test(steps + 1 == route.cells.size() && cells == route.cells.size());
+
+			f = fopen(routeFile, "wb");
+			test(writeSolution(fileno(f), maze, route));
+			fclose(f);
+			string written(maze.size() + 1, '\0');
+			f = fopen(routeFile, "rb");
+			test(fread(&written[0], 1, written.size(), f) == soln.size());
+			fclose(f);
+			written.resize(soln.size());
+			test(written == soln);
+		}
+	}
+	remove(routeFile);
+
+	// Test that generated mazes are reproducible and that every engine
+	// finds a path of the same length (open rooms have many)
+
+	for (int kind = MAZE_PERFECT; kind <= MAZE_PORTALS; ++kind)
+	{
+		maze = generateMaze((MazeKind)kind, 41, 60, 7);
+		test(maze == generateMaze((MazeKind)kind, 41, 60, 7));
+		test(maze.size() == 41 * 61);
+		soln = solve(maze);
+		test(soln != maze);
+		for (SolveEngine engine : engines)
+		{
+			string other = solve(maze, engine);
+			test(count(other.begin(), other.end(), 'o') == count(soln.begin(), soln.end(), 'o'));
+		}
+	}
+
+	// Test the kernels ENGINE_AUTO picks past the small sizes: 16-bit
+	// offsets up to 65535 of them, 32-bit beyond
+
+	for (int size : { 100, 300 })
+	{
+		for (int kind = MAZE_PERFECT; kind <= MAZE_PORTALS; ++kind)
+		{
+			maze = generateMaze((MazeKind)kind, size, size, 3);
+			soln = solve(maze, ENGINE_AUTO);
+			string other = solve(maze, ENGINE_HEAP);
+			test(soln != maze);
+			test(count(soln.begin(), soln.end(), 'o') == count(other.begin(), other.end(), 'o'));
+		}
+	}
+
+	// Test ENGINE_CORRIDOR on a maze whose path leaves through a portal
+	// at the tip of a branch, past two dead ends that get filled
+
+	maze = "";
+	maze += "#### #####\n";
+	maze += "#1      ##\n";
+	maze += "######## #\n";
+	maze += "#1       #\n";
+	maze += "######## #\n";
+	soln = "";
+	soln += "####o#####\n";
+	soln += "#oooo   ##\n";
+	soln += "######## #\n";
+	soln += "#oooooooo#\n";
+	soln += "########o#\n";
+	test(solve(maze, ENGINE_CORRIDOR) == soln);
+	test(solve(maze, ENGINE_HEAP) == soln);
+
+	// Test the solve statistics, which stay zero unless the solver is
+	// built with MAZE_STATS
+
+	maze = generateMaze(MAZE_PORTALS, 41, 60, 7);
+	for (SolveEngine engine : engines)
+	{
+		SolveStats stats;
+		soln = maze;
+		test(solveInto(maze, &soln[0], engine, &stats));
+		if (SearchCounters::enabled)
+		{
+			test(stats.pathLength == (size_t)count(soln.begin(), soln.end(), 'o'));
+			test(stats.settled > 0 && stats.pops >= stats.settled);
+			test(stats.pushes >= stats.pops && stats.maxQueued > 0);
+			test((stats.vertices > 0) == (engine != ENGINE_IMPLICIT && engine != ENGINE_JPS && engine != ENGINE_AUTO));
+			test(stats.edges >= stats.vertices);
+		}
+		else
+		{
+			test(stats.pushes == 0 && stats.pathLength == 0 && stats.searchNs == 0);
+		}
+	}
+
+	// Test MinPriorityQueue with a hashed index and with a dense one
+
+	MinPriorityQueue<string, 8> named;
+	named.push("c", 3);
+	named.push("a", 5);
+	named.push("b", 4);
+	named.decrease_key("a", 1);
+	test(named.front() == "a");
+	named.pop();
+	test(named.front() == "c");
+	named.pop();
+	test(named.front() == "b");
+
+	MinPriorityQueue<int, 4> ids;
+	ids.reserve(64);
+	for (int i = 0; i < 64; ++i)
+		ids.push(i, 1000 - i);
+	for (int i = 0; i < 64; i += 2)
+		ids.decrease_key(i, i);
+	for (int i = 0; i < 64; i += 2)
+	{
+		test(ids.front() == i);
+		ids.pop();
+	}
+	for (int i = 63; i >= 1; i -= 2)
+	{
+		test(ids.front() == i);
+		ids.pop();
+	}
+	test(ids.size() == 0);
+
+	// Test a MinPriorityQueue drawing from a fixed buffer
+
+	char buffer[4096];
+	pmr::monotonic_buffer_resource arena(buffer, sizeof buffer, pmr::null_memory_resource());
+	MinPriorityQueue<int, 4> pooled(&arena);
+	pooled.reserve(100);
+	for (int i = 0; i < 100; ++i)
+		pooled.push(i, (i * 37) % 100);
+	for (int p = 0; p < 100; ++p)
+	{
+		test(pooled.front() == (p * 73) % 100);
+		pooled.pop();
+	}
+
 	cout << "Assignment complete." << endl;
 }
 
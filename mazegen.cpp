@@ -0,0 +1,156 @@
+#include <random>
+#include <utility>
+#include <vector>
+#include "mazegen.h"
+
+using namespace std;
+
+// Helper function: carves a perfect maze into a grid of walls.
+// Cells sit at odd (row, col); the walk knocks out the wall between a
+// cell and a random unvisited neighbor, backtracking when stuck.
+static void carvePerfect(vector<string> &grid, mt19937 &rng) {
+    int rows = grid.size(), cols = grid[0].size();
+    vector< pair<int, int> > stack;
+    grid[1][1] = ' ';
+    stack.push_back({1, 1});
+    const int dr[4] = {-2, 2, 0, 0};
+    const int dc[4] = {0, 0, -2, 2};
+    while (!stack.empty()) {
+        int r = stack.back().first, c = stack.back().second;
+        int options[4], count = 0;
+        for (int d = 0; d < 4; d++) {
+            int nr = r + dr[d], nc = c + dc[d];
+            if (nr > 0 && nr < rows - 1 && nc > 0 && nc < cols - 1 && grid[nr][nc] == '#')
+                options[count++] = d;
+        }
+        if (count == 0) {
+            stack.pop_back();
+            continue;
+        }
+        int d = options[rng() % count];
+        grid[r + dr[d] / 2][c + dc[d] / 2] = ' ';
+        grid[r + dr[d]][c + dc[d]] = ' ';
+        stack.push_back({r + dr[d], c + dc[d]});
+    }
+}
+
+// Helper function: splits the interior into rooms about a tenth of the
+// maze across, with one doorway in each dividing wall segment.
+static void buildRooms(vector<string> &grid, mt19937 &rng) {
+    int rows = grid.size(), cols = grid[0].size();
+    for (int r = 1; r < rows - 1; r++)
+        for (int c = 1; c < cols - 1; c++)
+            grid[r][c] = ' ';
+    int roomRows = max(4, rows / 10), roomCols = max(4, cols / 10);
+    for (int r = roomRows; r < rows - 1; r += roomRows) {
+        for (int c = 1; c < cols - 1; c++)
+            grid[r][c] = '#';
+        for (int c = 1; c < cols - 1; c += roomCols)
+            grid[r][min(cols - 2, c + (int)(rng() % roomCols))] = ' ';
+    }
+    for (int c = roomCols; c < cols - 1; c += roomCols) {
+        for (int r = 1; r < rows - 1; r++)
+            if (grid[r][c] == ' ' && (r % roomRows) != 0)
+                grid[r][c] = '#';
+        for (int r = 1; r < rows - 1; r += roomRows) {
+            int door = min(rows - 2, r + (int)(rng() % roomRows));
+            if (door % roomRows == 0)
+                door = door > 1 ? door - 1 : door + 1;
+            grid[door][c] = ' ';
+        }
+    }
+}
+
+// Helper function: one corridor that runs the full width of every
+// other row, turning at alternating ends.
+static void buildCorridors(vector<string> &grid) {
+    int rows = grid.size(), cols = grid[0].size();
+    for (int r = 1; r < rows - 1; r += 2) {
+        for (int c = 1; c < cols - 1; c++)
+            grid[r][c] = ' ';
+        if (r + 2 < rows - 1)
+            grid[r + 1][(r / 2) % 2 ? 1 : cols - 2] = ' ';
+    }
+}
+
+// Helper function: places each digit on exactly two random open
+// interior cells, so all ten form portals.
+static void placePortals(vector<string> &grid, mt19937 &rng) {
+    int rows = grid.size(), cols = grid[0].size();
+    for (char d = '0'; d <= '9'; d++) {
+        for (int placed = 0, tries = 0; placed < 2 && tries < 1000; tries++) {
+            int r = 1 + rng() % (rows - 2), c = 1 + rng() % (cols - 2);
+            if (grid[r][c] == ' ') {
+                grid[r][c] = d;
+                placed++;
+            }
+        }
+    }
+}
+
+// Helper function: opens the top row above the first open cell of the
+// second row, and digs the bottom exit straight down from the lowest
+// open cell (even sizes leave the second-to-last row solid).
+static void openExits(vector<string> &grid) {
+    int rows = grid.size(), cols = grid[0].size();
+    for (int c = 1; c < cols - 1; c++) {
+        if (grid[1][c] != '#') {
+            grid[0][c] = ' ';
+            break;
+        }
+    }
+    for (int r = rows - 2; r > 0; r--) {
+        for (int c = cols - 2; c > 0; c--) {
+            if (grid[r][c] != '#') {
+                for (int below = r + 1; below < rows; below++)
+                    grid[below][c] = ' ';
+                return;
+            }
+        }
+    }
+}
+
+string generateMaze(MazeKind kind, int rows, int cols, unsigned seed) {
+    mt19937 rng(seed);
+    vector<string> grid(rows, string(cols, '#'));
+    switch (kind) {
+    case MAZE_ROOMS:
+        buildRooms(grid, rng);
+        break;
+    case MAZE_CORRIDORS:
+        buildCorridors(grid);
+        break;
+    case MAZE_PORTALS:
+        carvePerfect(grid, rng);
+        placePortals(grid, rng);
+        break;
+    default:
+        carvePerfect(grid, rng);
+        break;
+    }
+    openExits(grid);
+
+    string maze;
+    maze.reserve((size_t)rows * (cols + 1));
+    for (const string &row : grid) {
+        maze += row;
+        maze += '\n';
+    }
+    return maze;
+}
+
+static const char *KIND_NAMES[] = {"perfect", "rooms", "corridors", "portals"};
+
+const char *mazeKindName(MazeKind kind) {
+    return KIND_NAMES[kind];
+}
+
+bool parseMazeKind(const string &name, MazeKind &kind) {
+    for (int k = 0; k < 4; k++) {
+        if (name == KIND_NAMES[k]) {
+            kind = (MazeKind)k;
+            return true;
+        }
+    }
+    return false;
+}
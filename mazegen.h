@@ -0,0 +1,28 @@
+#ifndef MAZEGEN_H
+#define MAZEGEN_H
+
+#include <string>
+
+using namespace std;
+
+// Shapes of generated maze.
+enum MazeKind
+{
+    MAZE_PERFECT,   // Corridors carved by a random depth-first walk: one path between any two cells
+    MAZE_ROOMS,     // Large open rooms joined by single doorways
+    MAZE_CORRIDORS, // One long serpentine corridor, the worst case for path length
+    MAZE_PORTALS    // A perfect maze with all ten portal pairs spread over it
+};
+
+// Returns a rows x cols maze of the given kind, in the solve() format,
+// with exactly two exits: one on the top row and one on the bottom row.
+// The same kind, size and seed always give the same maze.
+// rows and cols must be at least 3.
+string generateMaze(MazeKind kind, int rows, int cols, unsigned seed);
+
+// Name of a kind ("perfect", "rooms", "corridors", "portals"), and the
+// reverse lookup; parseMazeKind returns false for unknown names.
+const char *mazeKindName(MazeKind kind);
+bool parseMazeKind(const string &name, MazeKind &kind);
+
+#endif
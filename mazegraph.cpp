@@ -0,0 +1,109 @@
+#include "mazegraph.h"
+
+using namespace std;
+
+void buildMazeGraph(const MazeGrid &grid, MazeGraph &g) {
+    MazeScan scan;
+    scanMaze(grid, scan);
+    buildMazeGraph(grid, scan, g);
+}
+
+void buildMazeGraph(const MazeGrid &grid, const MazeScan &scan, MazeGraph &g) {
+    int rowCount = grid.rows;
+    int colCount = grid.cols;
+    int words = scan.wordsPerRow;
+    g.rows = rowCount;
+    g.cols = colCount;
+    g.cellPos.clear();
+    g.cellId.assign((size_t)rowCount * colCount, MazeGraph::NONE);
+    g.offsets.clear();
+    g.targets.clear();
+    g.weights.clear();
+    g.start = g.goal = MazeGraph::NONE;
+    g.portals.clear();
+
+    // Size cellPos from the open bits up front, so numbering fills it
+    // in place.
+    size_t openCount = 0;
+    for (uint64_t w : scan.walls)
+        openCount += __builtin_popcountll(~w);
+    g.cellPos.resize(openCount);
+    uint32_t *cellPos = g.cellPos.writable();
+
+    // Number the open cells straight from the wall bitmap, and count
+    // the adjacent open pairs with a popcount per word: each pair
+    // contributes two directed edges.
+    uint32_t *cellId = g.cellId.writable();
+    uint32_t cellCount = 0;
+    size_t edgeCount = 0;
+    for (int r = 0; r < rowCount; r++) {
+        const uint64_t *walls = &scan.walls[(size_t)r * words];
+        uint64_t carry = 0;
+        for (int w = 0; w < words; w++) {
+            uint64_t open = ~walls[w];
+            uint64_t left = open << 1 | carry;
+            carry = open >> 63;
+            edgeCount += 2 * __builtin_popcountll(open & left);
+            if (r > 0)
+                edgeCount += 2 * __builtin_popcountll(open & ~walls[w - words]);
+            for (; open; open &= open - 1) {
+                uint32_t pos = (uint32_t)r * colCount + w * 64 + __builtin_ctzll(open);
+                cellId[pos] = cellCount;
+                cellPos[cellCount++] = pos;
+            }
+        }
+    }
+
+    // The scan names cells by their offset in the maze string.
+    const uint32_t *ids = cellId;
+    auto idOf = [&](uint32_t offset) {
+        return offset == MazeScan::NONE ? MazeGraph::NONE
+            : ids[offset / grid.stride * colCount + offset % grid.stride];
+    };
+    g.start = idOf(scan.start);
+    g.goal = idOf(scan.goal);
+    uint32_t portalEnds[10][2];
+    for (int d = 0; d < 10; d++) {
+        portalEnds[d][0] = idOf(scan.ends[d][0]);
+        portalEnds[d][1] = idOf(scan.ends[d][1]);
+    }
+    for (const PortalPair &p : scan.portals) {
+        g.portals.push_back({idOf(p.a), idOf(p.b), p.cost});
+        edgeCount += 2;
+    }
+
+    // Lay out each cell's edges contiguously, in id order. The counts
+    // above are exact, so the arrays are filled in place.
+    g.offsets.resize(cellCount + 1);
+    g.targets.resize(edgeCount);
+    g.weights.resize(edgeCount);
+    uint32_t *offsets = g.offsets.writable();
+    uint32_t *targets = g.targets.writable();
+    uint8_t *weights = g.weights.writable();
+    uint32_t e = 0;
+    for (uint32_t v = 0; v < cellCount; v++) {
+        int r = cellPos[v] / colCount;
+        int c = cellPos[v] % colCount;
+        size_t pos = cellPos[v];
+        offsets[v] = e;
+        uint32_t adjacent[4] = {
+            r > 0 ? ids[pos - colCount] : MazeGraph::NONE,
+            r < rowCount - 1 ? ids[pos + colCount] : MazeGraph::NONE,
+            c > 0 ? ids[pos - 1] : MazeGraph::NONE,
+            c < colCount - 1 ? ids[pos + 1] : MazeGraph::NONE
+        };
+        for (int i = 0; i < 4; i++) {
+            if (adjacent[i] != MazeGraph::NONE) {
+                targets[e] = adjacent[i];
+                weights[e++] = 1;
+            }
+        }
+        char ch = grid.at(r, c);
+        if (ch >= '0' && ch <= '9' && portalEnds[ch - '0'][0] != MazeGraph::NONE) {
+            const uint32_t *ends = portalEnds[ch - '0'];
+            targets[e] = ends[0] == v ? ends[1] : ends[0];
+            weights[e++] = ch - '0';
+        }
+    }
+    offsets[cellCount] = e;
+}
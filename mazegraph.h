@@ -0,0 +1,71 @@
+#ifndef MAZEGRAPH_H
+#define MAZEGRAPH_H
+
+#include <cstdint>
+#include <vector>
+#include "mazegrid.h"
+#include "mazescan.h"
+#include "viewarray.h"
+
+using namespace std;
+
+// A compact graph over the open cells of a maze, stored in
+// compressed sparse row (CSR) form.
+//
+// Open cells get dense ids 0..size()-1 in row-major order.
+// The edges leaving cell v are targets[offsets[v]] through
+// targets[offsets[v+1] - 1], with matching costs in weights.
+// Edges are listed up, down, left, right, then the portal jump,
+// so the search visits neighbors in a fixed order.
+//
+// The arrays may view a packed maze's graph section instead of owning
+// a copy; see PackedMaze::loadGraph().
+class MazeGraph
+{
+    public:
+        static constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+        MazeGraph() {}
+        MazeGraph(pmr::memory_resource *memory) :
+            cellPos(memory), cellId(memory), offsets(memory), targets(memory),
+            weights(memory), portals(memory)
+        {
+        }
+
+        // Maze dimensions
+        int rows = 0;
+        int cols = 0;
+
+        // Row-major grid position (row * cols + col) of each cell id
+        ViewArray<uint32_t> cellPos;
+
+        // Cell id of each grid position, or NONE for walls
+        ViewArray<uint32_t> cellId;
+
+        // CSR edge arrays
+        ViewArray<uint32_t> offsets;
+        ViewArray<uint32_t> targets;
+        ViewArray<uint8_t> weights;
+
+        // The first two boundary exits in row-major order, or NONE
+        uint32_t start = NONE;
+        uint32_t goal = NONE;
+
+        // Usable portal pairs, in digit order
+        pmr::vector<PortalPair> portals;
+
+        uint32_t size() const { return cellPos.size(); }
+        int row(uint32_t v) const { return cellPos[v] / cols; }
+        int col(uint32_t v) const { return cellPos[v] % cols; }
+};
+
+// Builds the graph for a maze grid.
+// Adjacent moves cost 1; a digit that appears exactly twice
+// links its two cells with a portal edge costing that digit.
+void buildMazeGraph(const MazeGrid &grid, MazeGraph &g);
+
+// Same, reusing a scanMaze result for the same grid instead of
+// scanning it again.
+void buildMazeGraph(const MazeGrid &grid, const MazeScan &scan, MazeGraph &g);
+
+#endif
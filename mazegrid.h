@@ -0,0 +1,39 @@
+#ifndef MAZEGRID_H
+#define MAZEGRID_H
+
+#include <cstddef>
+#include <string_view>
+
+using namespace std;
+
+// A read-only view of a maze string as a grid of rows.
+// Nothing is copied: cell (r, c) is data[r * stride + c],
+// where stride is the row length plus its newline.
+class MazeGrid
+{
+    public:
+        const char *data = nullptr;
+        int rows = 0;
+        int cols = 0;
+        size_t stride = 0;
+
+        char at(int r, int c) const { return data[offset(r, c)]; }
+        size_t offset(int r, int c) const { return (size_t)r * stride + c; }
+};
+
+// Helper function: views the maze string (rows ended by newlines) as a grid.
+// Every row must have the length of the first; anything after the
+// last newline is ignored.
+inline MazeGrid parseMaze(string_view maze) {
+    MazeGrid grid;
+    size_t newline = maze.find('\n');
+    if (newline == string_view::npos)
+        return grid;
+    grid.data = maze.data();
+    grid.cols = newline;
+    grid.stride = newline + 1;
+    grid.rows = maze.size() / grid.stride;
+    return grid;
+}
+
+#endif
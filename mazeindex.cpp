@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include "cellstate.h"
+#include "gridsearch.h"
+#include "mazeindex.h"
+
+using namespace std;
+
+// Helper function: how many trees of maze fit in DEFAULT_TREE_BYTES,
+// and at least one.
+static int defaultTrees(string_view maze) {
+    MazeGrid grid = parseMaze(maze);
+    size_t bytes = parentCodeBytes((size_t)grid.rows * grid.stride);
+    return bytes == 0 ? 1 : max((size_t)1, min(MazeIndex::DEFAULT_TREE_BYTES / bytes, (size_t)INT_MAX));
+}
+
+MazeIndex::MazeIndex(string_view maze) : MazeIndex(maze, defaultTrees(maze)) {
+}
+
+MazeIndex::MazeIndex(string_view maze, int maxTrees) : maze(maze) {
+    grid = parseMaze(this->maze);
+    if (grid.rows == 0)
+        return;
+    scanMaze(grid, scan);
+    for (int r = 0; r < grid.rows; r++) {
+        bool edgeRow = r == 0 || r == grid.rows - 1;
+        for (int c = 0; c < grid.cols; c += edgeRow || grid.cols == 1 ? 1 : grid.cols - 1) {
+            if (grid.at(r, c) != '#')
+                boundary.push_back({r, c});
+        }
+    }
+
+    // A tree from each of the first maxTrees exits, and the costs
+    // between them read off as each tree is grown.
+    for (size_t i = 0; i < boundary.size() && (int)i < maxTrees; i++)
+        roots.push_back(grid.offset(boundary[i].first, boundary[i].second));
+    size_t k = roots.size();
+    codeBytes = parentCodeBytes((size_t)grid.rows * grid.stride);
+    trees.resize(k * codeBytes);
+    rootCost.assign(k * k, -1);
+    for (size_t i = 0; i < k; i++) {
+        growTree(roots[i], MazeScan::NONE);
+        memcpy(&trees[i * codeBytes], scratch.parentCodes.data(), codeBytes);
+        for (size_t j = 0; j < k; j++)
+            rootCost[i * k + j] = implicitCost(grid, scratch, roots[j]);
+    }
+}
+
+// Helper function: the offset of the open cell at (r, c), or NONE for
+// walls and positions outside the maze.
+uint32_t MazeIndex::openCell(int r, int c) const {
+    if (r < 0 || r >= grid.rows || c < 0 || c >= grid.cols || grid.at(r, c) == '#')
+        return MazeScan::NONE;
+    return grid.offset(r, c);
+}
+
+// Helper function: the index in roots of cell, or -1 if it has no tree.
+int MazeIndex::treeOf(uint32_t cell) const {
+    auto it = lower_bound(roots.begin(), roots.end(), cell);
+    return it != roots.end() && *it == cell ? it - roots.begin() : -1;
+}
+
+// Helper function: runs implicitDijkstra from root, until it settles
+// goal or, if goal is NONE, every cell it can reach. Cells it does not
+// reach keep the parent code FROM_NONE.
+bool MazeIndex::growTree(uint32_t root, uint32_t goal) {
+    scan.start = root;
+    scan.goal = goal;
+    scratch.parentCodes.assign(codeBytes, 0);
+    return implicitDijkstra(grid, scan, scratch);
+}
+
+// Helper function: follows the parent codes of the tree grown from
+// root back from cell, marking each cell with 'o' in out unless out is
+// null. Returns the cost of the path, or -1 if the tree does not reach
+// cell.
+int MazeIndex::walk(const uint8_t *codes, uint32_t root, uint32_t cell, char *out) const {
+    if (cell != root && getParentCode(codes, cell) == FROM_NONE)
+        return -1;
+    int cost = 0;
+    uint32_t cur = cell;
+    while (true) {
+        if (out)
+            out[cur] = 'o';
+        if (cur == root)
+            return cost;
+        switch (getParentCode(codes, cur)) {
+        case FROM_UP:
+            cur -= grid.stride;
+            cost++;
+            break;
+        case FROM_DOWN:
+            cur += grid.stride;
+            cost++;
+            break;
+        case FROM_LEFT:
+            cur -= 1;
+            cost++;
+            break;
+        case FROM_RIGHT:
+            cur += 1;
+            cost++;
+            break;
+        default:
+            int d = grid.data[cur] - '0';
+            cur = scan.ends[d][0] == cur ? scan.ends[d][1] : scan.ends[d][0];
+            cost += d;
+            break;
+        }
+    }
+}
+
+// Helper function: the cost of a shortest path from one open cell to
+// another, marking it in out unless out is null; -1 if there is none.
+int MazeIndex::query(uint32_t from, uint32_t to, char *out) {
+    int fromTree = treeOf(from), toTree = treeOf(to);
+    if (fromTree >= 0 && toTree >= 0) {
+        int cost = rootCost[(size_t)fromTree * roots.size() + toTree];
+        if (cost < 0 || !out)
+            return cost;
+    }
+
+    // Paths can be walked either way, so either end's tree will do.
+    if (fromTree >= 0)
+        return walk(&trees[fromTree * codeBytes], from, to, out);
+    if (toTree >= 0)
+        return walk(&trees[toTree * codeBytes], to, from, out);
+    searchCount++;
+    if (!growTree(from, to))
+        return -1;
+    return walk(scratch.parentCodes.data(), from, to, out);
+}
+
+int MazeIndex::distance(int fromRow, int fromCol, int toRow, int toCol) {
+    uint32_t from = openCell(fromRow, fromCol);
+    uint32_t to = openCell(toRow, toCol);
+    if (from == MazeScan::NONE || to == MazeScan::NONE)
+        return -1;
+    return query(from, to, nullptr);
+}
+
+string MazeIndex::solve(int fromRow, int fromCol, int toRow, int toCol) {
+    string solution(maze);
+    solveInto(fromRow, fromCol, toRow, toCol, &solution[0]);
+    return solution;
+}
+
+bool MazeIndex::solveInto(int fromRow, int fromCol, int toRow, int toCol, char *out) {
+    if (out != maze.data())
+        memcpy(out, maze.data(), maze.size());
+    uint32_t from = openCell(fromRow, fromCol);
+    uint32_t to = openCell(toRow, toCol);
+    if (from == MazeScan::NONE || to == MazeScan::NONE)
+        return false;
+    return query(from, to, out) >= 0;
+}
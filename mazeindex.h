@@ -0,0 +1,91 @@
+#ifndef MAZEINDEX_H
+#define MAZEINDEX_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "mazegrid.h"
+#include "mazescan.h"
+#include "search.h"
+
+using namespace std;
+
+// A maze prepared once for many shortest-path queries between
+// arbitrary cells, typically its boundary exits.
+//
+// Building the index runs one full Dijkstra from each of the first
+// exits and keeps the shortest-path tree it leaves, as the packed
+// parent codes of cellstate.h: half a byte per cell per exit. The
+// costs between exits with trees go in a table. A query between two
+// of them then reads its cost from the table, and unpacks its path by
+// walking the tree of one exit back from the other, with no search at
+// all. A query from an exit with a tree to any other cell walks the
+// exit's tree the same way.
+//
+// Trees are kept only for the first exits in row-major order, so a
+// maze with a wide-open border does not cost a search and a tree per
+// border cell: by default as many as fit in DEFAULT_TREE_BYTES, which
+// is every exit of a maze up to a few hundred cells on a side, or
+// maxTrees if given. A query with no tree at either end falls back to
+// a search from scratch, which costs as much as solving the maze;
+// searches() counts them, so a caller can tell whether its queries
+// are the cheap kind.
+//
+// Queries reuse internal buffers, so a MazeIndex must not be queried
+// from two threads at once.
+class MazeIndex
+{
+    public:
+        // Bytes of trees the one-argument constructor keeps at most.
+        static const size_t DEFAULT_TREE_BYTES = 64 << 20;
+
+        // Indexes a copy of maze, with trees for as many exits as fit
+        // in DEFAULT_TREE_BYTES (at least one), or for up to maxTrees.
+        MazeIndex(string_view maze);
+        MazeIndex(string_view maze, int maxTrees);
+
+        // The number of exits given trees.
+        size_t treeCount() const { return roots.size(); }
+
+        // The number of queries so far that had no tree at either end
+        // and searched.
+        size_t searches() const { return searchCount; }
+
+        // The open boundary cells as (row, col), in row-major order.
+        const vector< pair<int, int> > &exits() const { return boundary; }
+
+        // Returns the cost of a shortest path between two open cells,
+        // or -1 if either is a wall or no path joins them.
+        int distance(int fromRow, int fromCol, int toRow, int toCol);
+
+        // Returns the maze with a shortest path between two open cells
+        // marked with 'o', or the maze unchanged if there is none.
+        string solve(int fromRow, int fromCol, int toRow, int toCol);
+
+        // Same as solve(), writing into out, which must hold
+        // maze.size() chars. Returns whether a path was found.
+        bool solveInto(int fromRow, int fromCol, int toRow, int toCol, char *out);
+
+    private:
+        uint32_t openCell(int r, int c) const;
+        int treeOf(uint32_t cell) const;
+        bool growTree(uint32_t root, uint32_t goal);
+        int walk(const uint8_t *codes, uint32_t root, uint32_t cell, char *out) const;
+        int query(uint32_t from, uint32_t to, char *out);
+
+        string maze;
+        MazeGrid grid;
+        MazeScan scan;
+        SearchScratch scratch;
+        vector< pair<int, int> > boundary;
+
+        vector<uint32_t> roots;  // The exits with trees, as offsets
+        vector<uint8_t> trees;   // Their parent codes, one block of codeBytes each
+        size_t codeBytes = 0;
+        vector<int> rootCost;    // Cost between roots i and j at [i * roots.size() + j], or -1
+        size_t searchCount = 0;
+};
+
+#endif
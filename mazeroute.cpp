@@ -0,0 +1,110 @@
+#include <algorithm>
+#include "fdio.h"
+#include "mazegrid.h"
+#include "mazeroute.h"
+
+using namespace std;
+
+// Bytes writeSolution() hands to each write, rounded to whole rows.
+static const size_t WRITE_BLOCK = 64 << 10;
+
+// Helper function: the move from cell from to cell to, the next cell
+// of route.
+static RouteMove moveBetween(const MazeRoute &route, uint32_t from, uint32_t to) {
+    uint32_t stride = route.cols + 1;
+    if (to + stride == from)
+        return MOVE_UP;
+    if (from + stride == to)
+        return MOVE_DOWN;
+    if (to + 1 == from)
+        return MOVE_LEFT;
+    if (from + 1 == to)
+        return MOVE_RIGHT;
+    return MOVE_PORTAL;
+}
+
+vector<MoveRun> routeMoves(const MazeRoute &route) {
+    vector<MoveRun> moves;
+    for (size_t i = 1; i < route.cells.size(); i++) {
+        RouteMove move = moveBetween(route, route.cells[i - 1], route.cells[i]);
+        if (!moves.empty() && moves.back().move == move)
+            moves.back().count++;
+        else
+            moves.push_back({move, 1});
+    }
+    return moves;
+}
+
+string encodeMoves(const vector<MoveRun> &moves) {
+    string text;
+    for (const MoveRun &run : moves) {
+        if (run.count != 1)
+            text += to_string(run.count);
+        text += (char)run.move;
+    }
+    return text;
+}
+
+bool decodeMoves(string_view text, vector<MoveRun> &moves) {
+    moves.clear();
+    size_t i = 0;
+    while (i < text.size()) {
+        uint64_t count = 0;
+        size_t digits = 0;
+        for (; i < text.size() && text[i] >= '0' && text[i] <= '9'; i++, digits++) {
+            count = count * 10 + (text[i] - '0');
+            if (count > UINT32_MAX)
+                return false;
+        }
+        if (digits == 0)
+            count = 1;
+        if (count == 0 || i == text.size() || string_view("UDLRP").find(text[i]) == string_view::npos)
+            return false;
+        moves.push_back({(RouteMove)text[i++], (uint32_t)count});
+    }
+    return true;
+}
+
+vector<CellRun> routeRuns(const MazeRoute &route) {
+    vector<CellRun> runs;
+    RouteMove heading = MOVE_PORTAL; // The way the last run goes, or MOVE_PORTAL while it is one cell
+    for (size_t i = 0; i < route.cells.size(); i++) {
+        uint32_t cell = route.cells[i];
+        RouteMove move = i > 0 ? moveBetween(route, route.cells[i - 1], cell) : MOVE_PORTAL;
+        if (move == MOVE_PORTAL || (heading != MOVE_PORTAL && move != heading)) {
+            int r = route.row(cell), c = route.col(cell);
+            runs.push_back({r, c, r, c});
+            heading = MOVE_PORTAL;
+            continue;
+        }
+        runs.back().endRow = route.row(cell);
+        runs.back().endCol = route.col(cell);
+        heading = move;
+    }
+    return runs;
+}
+
+bool writeSolution(int fd, string_view maze, const MazeRoute &route) {
+    vector<uint32_t> marks(route.cells);
+    sort(marks.begin(), marks.end());
+    MazeGrid grid = parseMaze(maze);
+    size_t blockBytes = grid.rows > 0 ? max(WRITE_BLOCK / grid.stride, (size_t)1) * grid.stride : WRITE_BLOCK;
+
+    // Blocks without a mark go out straight from maze; the others are
+    // copied and marked first.
+    vector<char> block;
+    auto mark = marks.begin();
+    for (size_t begin = 0; begin < maze.size(); begin += blockBytes) {
+        size_t end = min(begin + blockBytes, maze.size());
+        const char *data = maze.data() + begin;
+        if (mark != marks.end() && *mark < end) {
+            block.assign(data, maze.data() + end);
+            for (; mark != marks.end() && *mark < end; ++mark)
+                block[*mark - begin] = 'o';
+            data = block.data();
+        }
+        if (!writeFull(fd, data, end - begin))
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,70 @@
+#ifndef MAZEROUTE_H
+#define MAZEROUTE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+// The cells of a maze's solution in the order they are walked, from
+// the start to the goal, as offsets in the maze string. Much smaller
+// than the solved maze when only the route is wanted.
+struct MazeRoute
+{
+    int rows = 0;
+    int cols = 0;
+    vector<uint32_t> cells;
+
+    int row(uint32_t cell) const { return cell / (cols + 1); }
+    int col(uint32_t cell) const { return cell % (cols + 1); }
+};
+
+// A move from one cell of a route to the next: a step to a
+// neighbour, or a jump through a portal.
+enum RouteMove : char
+{
+    MOVE_UP = 'U',
+    MOVE_DOWN = 'D',
+    MOVE_LEFT = 'L',
+    MOVE_RIGHT = 'R',
+    MOVE_PORTAL = 'P'
+};
+
+// A move made count times in a row.
+struct MoveRun
+{
+    RouteMove move;
+    uint32_t count;
+};
+
+// A straight stretch of a route, from (row, col) to (endRow, endCol)
+// inclusive. The next run starts at the cell after the end, beside it
+// or across a portal.
+struct CellRun
+{
+    int row, col;
+    int endRow, endCol;
+};
+
+// The moves of route, with runs of the same move merged.
+vector<MoveRun> routeMoves(const MazeRoute &route);
+
+// The moves of route as text: each run is its letter, preceded by its
+// count unless that is 1, e.g. "3R2DP4L".
+string encodeMoves(const vector<MoveRun> &moves);
+
+// Reverses encodeMoves(). Returns false if text is not in its form.
+bool decodeMoves(string_view text, vector<MoveRun> &moves);
+
+// The straight stretches of route, in order.
+vector<CellRun> routeRuns(const MazeRoute &route);
+
+// Writes maze to the file descriptor fd with the cells of route
+// overwritten by 'o', a few rows at a time, so the solved maze is
+// never held in memory whole. The output is what solveInto() leaves
+// in out. Returns false on a write error.
+bool writeSolution(int fd, string_view maze, const MazeRoute &route);
+
+#endif
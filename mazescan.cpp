@@ -0,0 +1,114 @@
+#include "mazescan.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+// Helper function: classifies n <= 64 bytes at p. Bit i of walls is set
+// when p[i] is '#', and bit i of digits when p[i] is '0' to '9'.
+// Full vectors are compared at once, the rest a byte at a time.
+static inline void classifyBytes(const char *p, int n, uint64_t &walls, uint64_t &digits) {
+    walls = digits = 0;
+    int i = 0;
+#if defined(__AVX2__)
+    const __m256i hash = _mm256_set1_epi8('#');
+    const __m256i zero = _mm256_set1_epi8('0');
+    const __m256i nine = _mm256_set1_epi8(9);
+    for (; i + 32 <= n; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(p + i));
+        __m256i d = _mm256_sub_epi8(x, zero);
+        uint32_t w = _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, hash));
+        uint32_t g = _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(d, nine), d));
+        walls |= (uint64_t)w << i;
+        digits |= (uint64_t)g << i;
+    }
+#elif defined(__SSE2__)
+    const __m128i hash = _mm_set1_epi8('#');
+    const __m128i zero = _mm_set1_epi8('0');
+    const __m128i nine = _mm_set1_epi8(9);
+    for (; i + 16 <= n; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(p + i));
+        // x - '0' is at most 9, unsigned, exactly for the digits.
+        __m128i d = _mm_sub_epi8(x, zero);
+        uint32_t w = _mm_movemask_epi8(_mm_cmpeq_epi8(x, hash));
+        uint32_t g = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(d, nine), d));
+        walls |= (uint64_t)w << i;
+        digits |= (uint64_t)g << i;
+    }
+#endif
+    for (; i < n; i++) {
+        walls |= (uint64_t)(p[i] == '#') << i;
+        digits |= (uint64_t)((unsigned char)(p[i] - '0') < 10) << i;
+    }
+}
+
+void scanMaze(const MazeGrid &grid, MazeScan &scan) {
+    scan.start = scan.goal = MazeScan::NONE;
+    scan.portals.clear();
+    uint32_t count[10] = {0};
+    for (int d = 0; d < 10; d++)
+        scan.ends[d][0] = scan.ends[d][1] = MazeScan::NONE;
+    scan.rows = grid.rows;
+    scan.cols = grid.cols;
+    scan.wordsPerRow = (grid.cols + 63) / 64;
+    scan.walls.resize((size_t)grid.rows * scan.wordsPerRow);
+
+    // One pass over the rows, 64 cells per bitmap word. Digits are rare,
+    // so their positions are picked out of the mask bit by bit.
+    for (int r = 0; r < grid.rows; r++) {
+        const char *row = grid.data + grid.offset(r, 0);
+        uint64_t *words = scan.walls.writable() + (size_t)r * scan.wordsPerRow;
+        bool edgeRow = r == 0 || r == grid.rows - 1;
+        for (int w = 0, c = 0; c < grid.cols; w++, c += 64) {
+            int n = grid.cols - c < 64 ? grid.cols - c : 64;
+            uint64_t walls, digits;
+            classifyBytes(row + c, n, walls, digits);
+            if (n < 64)
+                walls |= ~0ull << n;
+            words[w] = walls;
+
+            for (; digits; digits &= digits - 1) {
+                int i = c + __builtin_ctzll(digits);
+                int d = row[i] - '0';
+                if (count[d] < 2)
+                    scan.ends[d][count[d]] = grid.offset(r, i);
+                count[d]++;
+            }
+
+            // Every open cell of the first and last rows is an exit.
+            for (uint64_t open = edgeRow ? ~walls : 0; open && scan.goal == MazeScan::NONE; open &= open - 1) {
+                uint32_t cell = grid.offset(r, c + __builtin_ctzll(open));
+                if (scan.start == MazeScan::NONE)
+                    scan.start = cell;
+                else
+                    scan.goal = cell;
+            }
+        }
+
+        // In the other rows, only the first and last cells are.
+        if (!edgeRow && grid.cols > 0 && scan.goal == MazeScan::NONE) {
+            int sides[2] = {0, grid.cols - 1};
+            for (int s = 0; s < (grid.cols > 1 ? 2 : 1); s++) {
+                if (row[sides[s]] == '#')
+                    continue;
+                uint32_t cell = grid.offset(r, sides[s]);
+                if (scan.start == MazeScan::NONE)
+                    scan.start = cell;
+                else if (scan.goal == MazeScan::NONE)
+                    scan.goal = cell;
+            }
+        }
+    }
+
+    // Only digits that appear exactly twice form a portal.
+    for (int d = 0; d < 10; d++) {
+        if (count[d] == 2)
+            scan.portals.push_back({scan.ends[d][0], scan.ends[d][1], d});
+        else
+            scan.ends[d][0] = scan.ends[d][1] = MazeScan::NONE;
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef MAZESCAN_H
+#define MAZESCAN_H
+
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+#include "mazegrid.h"
+#include "viewarray.h"
+
+using namespace std;
+
+// A pair of portal cells and the cost of jumping between them.
+struct PortalPair
+{
+    uint32_t a;
+    uint32_t b;
+    int cost;
+};
+
+// What one pass over a MazeGrid finds: the exits, the usable portal
+// pairs and a bitmap of the walls. Cells are named by their offset in
+// the maze string (row * stride + col), so they index the input bytes
+// directly.
+class MazeScan
+{
+    public:
+        static constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+        MazeScan() {}
+        MazeScan(pmr::memory_resource *memory) : portals(memory), walls(memory) {}
+
+        // The first two boundary exits in row-major order, or NONE
+        uint32_t start = NONE;
+        uint32_t goal = NONE;
+
+        // Digits that appear exactly twice, in digit order
+        pmr::vector<PortalPair> portals;
+
+        // Cell offsets of the two ends of each portal, by digit;
+        // NONE for digits that do not form a portal.
+        uint32_t ends[10][2];
+
+        // Packed wall bitmap, wordsPerRow 64-bit words per row: bit c % 64
+        // of walls[r * wordsPerRow + c / 64] is set when cell (r, c) is '#'.
+        // Bits past the last column are set, so they read as walls.
+        // May view a packed maze's walls section; see PackedMaze::loadScan().
+        int rows = 0;
+        int cols = 0;
+        int wordsPerRow = 0;
+        ViewArray<uint64_t> walls;
+
+        bool wall(int r, int c) const
+        {
+            return walls[(size_t)r * wordsPerRow + c / 64] >> (c % 64) & 1;
+        }
+};
+
+// Finds the exits and portal pairs of a maze grid and fills the wall
+// bitmap, in one pass that compares 16 bytes at a time with SSE2 or 32
+// with AVX2 (when compiled with -mavx2), falling back to plain byte
+// compares on other targets.
+void scanMaze(const MazeGrid &grid, MazeScan &scan);
+
+#endif
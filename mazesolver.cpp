@@ -0,0 +1,219 @@
+#include <algorithm>
+#include "bitsearch.h"
+#include "cellstate.h"
+#include "gridsearch.h"
+#include "kernelsearch.h"
+#include "mazesolver.h"
+#include "parallelsearch.h"
+
+using namespace std;
+
+bool MazeSolver::solveInto(string_view maze, char *out, SolveEngine engine, SolveStats *stats) {
+    return solve(maze, nullptr, out, engine, stats);
+}
+
+bool MazeSolver::solveInto(const PackedMaze &maze, char *out, SolveEngine engine, SolveStats *stats) {
+    return solve(maze.text(), &maze, out, engine, stats);
+}
+
+bool MazeSolver::solveRoute(string_view maze, MazeRoute &route, SolveEngine engine, SolveStats *stats) {
+    return solveRoute(maze, nullptr, route, engine, stats);
+}
+
+bool MazeSolver::solveRoute(const PackedMaze &maze, MazeRoute &route, SolveEngine engine, SolveStats *stats) {
+    return solveRoute(maze.text(), &maze, route, engine, stats);
+}
+
+// Helper function: solves maze, or the packed file it is the text of,
+// putting the path in out and filling stats if given.
+bool MazeSolver::solve(string_view maze, const PackedMaze *packed, PathOut out, SolveEngine engine,
+                       SolveStats *stats) {
+    SolveStats ignored;
+    SolveStats &st = stats ? *stats : ignored;
+    st = SolveStats();
+    scratch.counters.clear();
+    bool found = packed ? solvePacked(*packed, out, engine, st) : solvePhases(maze, out, engine, st);
+    scratch.counters.report(st);
+    return found;
+}
+
+// Helper function: solve() listing the path in route. Every engine
+// walks its path back from the goal, so the list is reversed.
+bool MazeSolver::solveRoute(string_view maze, const PackedMaze *packed, MazeRoute &route, SolveEngine engine,
+                            SolveStats *stats) {
+    bool found = solve(maze, packed, route.cells, engine, stats);
+    route.rows = lastGrid.rows;
+    route.cols = lastGrid.cols;
+    reverse(route.cells.begin(), route.cells.end());
+    return found;
+}
+
+// Helper function: solves maze, timing each phase into stats.
+bool MazeSolver::solvePhases(string_view maze, PathOut out, SolveEngine engine, SolveStats &stats) {
+    PhaseTimer timer;
+
+    // Unsolved mazes are returned as they are.
+    out.begin(maze);
+
+    // View the maze as a grid; rows are read straight from the input.
+    lastGrid = parseMaze(maze);
+    const MazeGrid &grid = lastGrid;
+    timer.lap(stats.parseNs);
+    if (grid.rows == 0)
+        return false;
+
+    // Find the exits, the portals and the walls in one pass.
+    scanMaze(grid, scan);
+    timer.lap(stats.scanNs);
+    if (scan.start == MazeScan::NONE || scan.goal == MazeScan::NONE)
+        return false;
+    return solveScanned(grid, nullptr, engine, out, stats, timer);
+}
+
+// Helper function: solvePhases() for a packed maze, whose text is
+// already split into rows and whose scan is stored.
+bool MazeSolver::solvePacked(const PackedMaze &maze, PathOut out, SolveEngine engine, SolveStats &stats) {
+    PhaseTimer timer;
+    out.begin(maze.text());
+    lastGrid = maze.grid();
+    const MazeGrid &grid = lastGrid;
+    timer.lap(stats.parseNs);
+
+    maze.loadScan(scan);
+    timer.lap(stats.scanNs);
+    if (scan.start == MazeScan::NONE || scan.goal == MazeScan::NONE)
+        return false;
+    return solveScanned(grid, &maze, engine, out, stats, timer);
+}
+
+// Helper function: solves a scanned maze with the given engine. packed
+// is the file the maze came from, or null.
+bool MazeSolver::solveScanned(const MazeGrid &grid, const PackedMaze *packed, SolveEngine engine, PathOut out,
+                              SolveStats &stats, PhaseTimer &timer) {
+    // The kernels mark the path themselves, so their search time
+    // includes rendering.
+    if (engine == ENGINE_AUTO) {
+        bool found = kernelSearch(grid, scan, scratch, out);
+        timer.lap(stats.searchNs);
+        return found;
+    }
+
+    // Breadth-first search only works while every move costs 1.
+    if (engine == ENGINE_BITBFS && !scan.portals.empty())
+        engine = ENGINE_HEAP;
+
+    if (engine == ENGINE_IMPLICIT || engine == ENGINE_BITBFS || engine == ENGINE_JPS)
+        return solveOnGrid(grid, engine, out, stats, timer);
+    if (engine == ENGINE_CORRIDOR)
+        return solveOnCorridors(grid, out, stats, timer);
+    return solveOnGraph(grid, packed, engine, out, stats, timer);
+}
+
+// Helper function: solves with one of the engines that run on a MazeGraph.
+bool MazeSolver::solveOnGraph(const MazeGrid &grid, const PackedMaze *packed, SolveEngine engine, PathOut out,
+                              SolveStats &stats, PhaseTimer &timer) {
+    // Build the flat graph of open cells, exits and portal edges, or
+    // load it from the file.
+    MazeGraph &g = graph;
+    if (packed && packed->hasGraph())
+        packed->loadGraph(g);
+    else
+        buildMazeGraph(grid, scan, g);
+    scratch.counters.built(g.size(), g.targets.size());
+    timer.lap(stats.buildNs);
+
+    // Find a shortest path with the requested engine.
+    bool found;
+    switch (engine) {
+    case ENGINE_BUCKET:
+        found = dijkstraBucket(g, scratch);
+        break;
+    case ENGINE_ASTAR:
+        found = astar(g, scratch);
+        break;
+    case ENGINE_PARALLEL:
+        found = deltaStepping(g, ThreadPool::shared(), scratch);
+        break;
+    default:
+        found = dijkstraHeap(g, scratch);
+        break;
+    }
+    timer.lap(stats.searchNs);
+    if (!found)
+        return false;
+
+    // Backtrack from goal to start and put the path straight in out.
+    const pmr::vector<uint32_t> &parent = scratch.parent;
+    for (uint32_t cur = g.goal; cur != MazeGraph::NONE; cur = parent[cur]) {
+        out.add(grid.offset(g.row(cur), g.col(cur)));
+        scratch.counters.pathCell();
+        if (cur == g.start)
+            break;
+    }
+    timer.lap(stats.renderNs);
+    return true;
+}
+
+// Helper function: solves with one of the engines that read the grid directly.
+bool MazeSolver::solveOnGrid(const MazeGrid &grid, SolveEngine engine, PathOut out, SolveStats &stats,
+                             PhaseTimer &timer) {
+    bool found;
+    if (engine == ENGINE_BITBFS)
+        found = bitParallelBfs(grid, scan, scratch);
+    else if (engine == ENGINE_JPS)
+        found = jumpPointSearch(grid, scan, scratch);
+    else
+        found = implicitDijkstra(grid, scan, scratch);
+    timer.lap(stats.searchNs);
+    if (!found)
+        return false;
+
+    if (engine == ENGINE_IMPLICIT) {
+        scratch.counters.pathCell(markParents(grid, scan, scratch.parentCodes.data(), out));
+        timer.lap(stats.renderNs);
+        return true;
+    }
+
+    // Parents are cell offsets, so they go to out as they are.
+    const pmr::vector<uint32_t> &parent = scratch.parent;
+    for (uint32_t cur = scan.goal; cur != MazeScan::NONE; cur = parent[cur]) {
+        out.add(cur);
+        scratch.counters.pathCell();
+        if (cur == scan.start)
+            break;
+    }
+    timer.lap(stats.renderNs);
+    return true;
+}
+
+// Helper function: solves on the graph of junctions left once the dead
+// ends are filled.
+bool MazeSolver::solveOnCorridors(const MazeGrid &grid, PathOut out, SolveStats &stats, PhaseTimer &timer) {
+    CorridorGraph &g = corridors;
+    buildCorridorGraph(grid, scan, g);
+    scratch.counters.built(g.size(), g.targets.size());
+    timer.lap(stats.buildNs);
+
+    bool found = dijkstraCorridors(g, scratch);
+    timer.lap(stats.searchNs);
+    if (!found)
+        return false;
+
+    // Put in out each vertex on the path and the cells of the edge
+    // that reached it, from the vertex's side back.
+    const pmr::vector<uint32_t> &parent = scratch.parent;
+    uint32_t cur = g.goal;
+    while (true) {
+        out.add(g.cellPos[cur]);
+        scratch.counters.pathCell();
+        uint32_t e = parent[cur];
+        if (cur == g.start || e == CorridorGraph::NONE)
+            break;
+        for (uint32_t i = g.pathOffsets[e + 1]; i > g.pathOffsets[e]; i--)
+            out.add(g.pathCells[i - 1]);
+        scratch.counters.pathCell(g.pathOffsets[e + 1] - g.pathOffsets[e]);
+        cur = g.source(e);
+    }
+    timer.lap(stats.renderNs);
+    return true;
+}
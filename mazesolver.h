@@ -0,0 +1,75 @@
+#ifndef MAZESOLVER_H
+#define MAZESOLVER_H
+
+#include <memory_resource>
+#include <string_view>
+#include "corridorgraph.h"
+#include "mazegraph.h"
+#include "mazeroute.h"
+#include "mazescan.h"
+#include "packedmaze.h"
+#include "pathout.h"
+#include "search.h"
+#include "threadpool.h"
+#include "solve.h"
+
+using namespace std;
+
+// Solves mazes one at a time, keeping the graph and search buffers
+// between calls. After the first few mazes, solving one of similar
+// size allocates nothing. Not safe to share between threads; give
+// each thread its own MazeSolver. ENGINE_PARALLEL runs on
+// ThreadPool::shared(), one pool for the whole process, so many
+// solvers do not start a thread per core each.
+//
+// The graph and search buffers come from the given memory resource;
+// a short-lived solver can draw them from an arena and drop them all
+// at once. ENGINE_PARALLEL's worker threads allocate their own bucket
+// lists on the default heap, since an arena is not thread-safe. The
+// resource must outlive the MazeSolver.
+class MazeSolver
+{
+    public:
+        MazeSolver() : MazeSolver(pmr::get_default_resource()) {}
+        MazeSolver(pmr::memory_resource *memory) :
+            graph(memory), corridors(memory), scan(memory), scratch(memory)
+        {
+        }
+
+        // Same as the free solveInto(maze, out, engine, stats).
+        bool solveInto(string_view maze, char *out, SolveEngine engine, SolveStats *stats = nullptr);
+
+        // Same as solveInto(maze.text(), out, engine, stats), taking
+        // the exits, portals and walls from the file instead of
+        // scanning, and its graph, if it has one, instead of building it.
+        bool solveInto(const PackedMaze &maze, char *out, SolveEngine engine, SolveStats *stats = nullptr);
+
+        // Solves maze and puts its route in route, for callers that
+        // want the path without the solved maze. The route is the path
+        // solveInto() would mark, listed straight from the engine's
+        // parents. Returns whether a path was found; if not, route is
+        // empty.
+        bool solveRoute(string_view maze, MazeRoute &route, SolveEngine engine, SolveStats *stats = nullptr);
+        bool solveRoute(const PackedMaze &maze, MazeRoute &route, SolveEngine engine, SolveStats *stats = nullptr);
+
+    private:
+        bool solve(string_view maze, const PackedMaze *packed, PathOut out, SolveEngine engine, SolveStats *stats);
+        bool solveRoute(string_view maze, const PackedMaze *packed, MazeRoute &route, SolveEngine engine,
+                        SolveStats *stats);
+        bool solvePhases(string_view maze, PathOut out, SolveEngine engine, SolveStats &stats);
+        bool solvePacked(const PackedMaze &maze, PathOut out, SolveEngine engine, SolveStats &stats);
+        bool solveScanned(const MazeGrid &grid, const PackedMaze *packed, SolveEngine engine, PathOut out,
+                          SolveStats &stats, PhaseTimer &timer);
+        bool solveOnGraph(const MazeGrid &grid, const PackedMaze *packed, SolveEngine engine, PathOut out,
+                          SolveStats &stats, PhaseTimer &timer);
+        bool solveOnGrid(const MazeGrid &grid, SolveEngine engine, PathOut out, SolveStats &stats, PhaseTimer &timer);
+        bool solveOnCorridors(const MazeGrid &grid, PathOut out, SolveStats &stats, PhaseTimer &timer);
+
+        MazeGraph graph;
+        CorridorGraph corridors;
+        MazeScan scan;
+        SearchScratch scratch;
+        MazeGrid lastGrid; // The maze of the last solve, as parsed
+};
+
+#endif
@@ -1,36 +1,94 @@
 #ifndef MINPRIORITYQUEUE_H
 #define MINPRIORITYQUEUE_H
-// NOTE: You may not include any other libraries!
+#include <memory_resource>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
-#include <utility> 
+#include <utility>
 using namespace std;
 
+// Maps heap values to their indices in the heap.
+// Integer values (dense cell ids) index a plain vector;
+// anything else falls back to an unordered_map.
+template <typename T, bool Dense = is_integral<T>::value>
+class HeapIndex
+{
+    pmr::unordered_map<T, int> I;
+
+public:
+    HeapIndex() {}
+    HeapIndex(pmr::memory_resource *memory) : I(memory) {}
+    int get(const T &x) { return I[x]; }
+    int find(const T &x) const
+    {
+        auto it = I.find(x);
+        return it == I.end() ? -1 : it->second;
+    }
+    void set(const T &x, int i) { I[x] = i; }
+    void reserve(int n) { I.reserve(n); }
+    void clear() { I.clear(); }
+};
+
 template <typename T>
+class HeapIndex<T, true>
+{
+    pmr::vector<int> I;
+
+public:
+    HeapIndex() {}
+    HeapIndex(pmr::memory_resource *memory) : I(memory) {}
+    int get(T x) { return I[x]; }
+    int find(T x) const { return (size_t)x < I.size() ? I[x] : -1; }
+    void set(T x, int i)
+    {
+        if ((size_t)x >= I.size())
+            I.resize((size_t)x + 1, -1);
+        I[x] = i;
+    }
+    void reserve(int n)
+    {
+        if ((size_t)n > I.size())
+            I.resize(n, -1);
+    }
+    // Positions are only read for values in the heap, and every push
+    // writes one, so stale entries can stay; clearing is O(1).
+    void clear() {}
+};
+
+// A min-priority queue stored as a D-ary heap.
+//
+// D = 2 is a binary heap; 4 or 8 make the tree shallower and keep
+// each node's children in one or two cache lines, which pays off
+// when pushes and decrease_key calls outnumber pops.
+// Sifting moves a hole instead of swapping, so each level costs
+// one move and one index update.
+//
+// Priorities are ints unless P names a wider type.
+template <typename T, int D = 2, typename P = int>
 class MinPriorityQueue
 {
     // For the mandatory running times below:
     //
     // n is the number of elements in the MinPriorityQueue.
     //
-    // Assume that the operations of unordered_map are O(1) time 
+    // Assume that the operations of unordered_map are O(1) time
     // (they are average case, but not worst-case).
-    // You don't need any other instance variables,
-    // but you can add some if you want to.
 
-    vector< pair<T, int> > H; // The heap.
-    unordered_map<T, int> I; // Maps values to their indices in H.
+    static_assert(D >= 2, "a heap needs at least two children per node");
+
+    pmr::vector< pair<T, P> > H; // The heap.
+    HeapIndex<T> I; // Maps values to their indices in H.
 
 public:
 
     // Creates an empty MinPriorityQueue
     MinPriorityQueue()
     {
-        // TODO
-        // so what goes here? return 0 if nothing
-        // delcare variables here but will they be global accessed in size and insert?
-        H.clear();
-        I.clear();
+    }
+
+    // Creates an empty MinPriorityQueue that allocates from memory
+    MinPriorityQueue(pmr::memory_resource *memory) : H(memory), I(memory)
+    {
     }
 
     // Returns the number of elements in the MinPriorityQueue.
@@ -38,133 +96,169 @@ public:
     // Must run in O(1) time.
     int size()
     {
-        // TODO 
         return H.size();
-    } 
+    }
+
+    // Makes room for n elements, so pushes do not reallocate.
+    // With integer values, n should exceed the largest value.
+    void reserve(int n)
+    {
+        H.reserve(n);
+        I.reserve(n);
+    }
+
+    // Removes every element but keeps the allocated storage.
+    void clear()
+    {
+        H.clear();
+        I.clear();
+    }
 
     // Pushes a new value x with priority p
     // into the MinPriorityQueue.
     //
-    // Must run in O(log(n)) time. 
-    void push(T x, int p)
+    // Must run in O(log(n)) time.
+    void push(T x, P p)
     {
-        // TODO
-        // create the pair
-        // push into vector(H)
         H.push_back({x, p});
-        // Map to H location in I
-        I[x] = H.size() - 1;
-        // bubble up that item
         bubbleUp(H.size() - 1);
     }
 
-    // helper function for bubbleup
-    void bubbleUp(int index) 
+    // helper function: moves the element at index up
+    // until its parent's priority is no larger.
+    void bubbleUp(int index)
     {
-        /*
-        if parent.second < child.second
-        swap parent, child
-        update index
-        update child as parent
-        bubbleUp() with Child as new Parent
-        */
-        // basecase: when root is reached
-        if (index == 0) return;
-
-        int parent = (index - 1) / 2;
-
-        if (H[parent].second > H[index].second)
+        pair<T, P> item = H[index];
+        while (index > 0)
         {
-            swap(H[parent], H[index]);
-            I[H[parent].first] = parent;
-            I[H[index].first] = index;
-            bubbleUp(parent);
+            int parent = (index - 1) / D;
+            if (H[parent].second <= item.second)
+                break;
+            H[index] = H[parent];
+            I.set(H[index].first, index);
+            index = parent;
         }
+        H[index] = item;
+        I.set(item.first, index);
     }
 
     // Returns the value at the front of the MinPriorityQueue.
     // Undefined behavior if the MinPriorityQueue is empty.
-    // 
+    //
     // Must run in O(1) time.
     T front()
     {
-        // TODO 
-        // pseudocode
-        // basecase H is empty
         if (!H.size()) return T(); // Returning default value of T
 
-        // return the root value x of H the front
-        // which library is .first from?
         return H[0].first;
     }
 
     // Removes the value at the front of the MinPriorityQueue.
     // Undefined behavior if the MinPriorityQueue is empty.
     //
-    // Must run in O(log(n)) time. 
+    // Must run in O(log(n)) time.
     void pop()
     {
-        // TODO 
-        // basecase empty H
         if (!H.size()) return;
 
-        // swap root 0 and last time H.size() -1
-        swap(H[0], H[H.size() - 1]);
-
-        // pop_back() that item
+        // Move the last element into the root and sift it down.
+        pair<T, P> last = H.back();
         H.pop_back();
-
-        // bubbledown() at the root
-        bubbleDown(0);
+        if (H.size())
+        {
+            H[0] = last;
+            bubbleDown(0);
+        }
     }
 
+    // helper function: moves the element at index down,
+    // swapping places with its smallest child, until no
+    // child has a smaller priority.
     void bubbleDown(int index)
     {
-        // pseudocode:
-        // swap the root with the last element in Heap
-        int leftChild = 2 * index + 1;
-        int rightChild = 2 * index + 2;
-        int smallest = index;
-
-        // bubbledown algo: swap parent if children smaller,
-        // swap with smallest child and repeat till Heap is fixed.
-        // if current index < than children, check to swap which one
-        // if Left child < Right swap left with parent, else vice versa.
-        if (leftChild < H.size() && H[leftChild].second < H[smallest].second) 
+        int n = H.size();
+        pair<T, P> item = H[index];
+        while (true)
         {
-            smallest = leftChild;
+            int first = D * index + 1;
+            if (first >= n)
+                break;
+            int last = first + D < n ? first + D : n;
+            int smallest = first;
+            for (int child = first + 1; child < last; child++)
+            {
+                if (H[child].second < H[smallest].second)
+                    smallest = child;
+            }
+            if (H[smallest].second >= item.second)
+                break;
+            H[index] = H[smallest];
+            I.set(H[index].first, index);
+            index = smallest;
         }
+        H[index] = item;
+        I.set(item.first, index);
+    }
 
-        if (rightChild < H.size() && H[rightChild].second < H[smallest].second) 
+    // If x is in the MinPriorityQueue
+    // with current priority at least new_p,
+    // then changes the priority of x to new_p.
+    // Undefined behavior otherwise.
+    //
+    // Must run in O(log(n)) time.
+    void decrease_key(T x, P new_p)
+    {
+        int index = I.get(x);
+        if (H[index].second > new_p)
         {
-            smallest = rightChild;
+            H[index].second = new_p;
+            bubbleUp(index);
         }
+    }
 
-        if (smallest != index) 
-        {
-            swap(H[index], H[smallest]);
-            I[H[index].first] = index;
-            I[H[smallest].first] = smallest;
-            bubbleDown(smallest); 
-        }
+    // Returns whether x is in the MinPriorityQueue.
+    //
+    // Runs in O(1) time.
+    bool contains(const T &x)
+    {
+        int index = I.find(x);
+        return index >= 0 && index < (int)H.size() && H[index].first == x;
     }
 
-    // If x is in the MinPriorityQueue 
-    // with current priority at least new_p, 
-    // then changes the priority of x to new_p.
+    // If x is in the MinPriorityQueue, changes
+    // its priority to new_p, lower or higher.
     // Undefined behavior otherwise.
     //
-    // Must run in O(log(n)) time. 
-    void decrease_key(T x, int new_p)
+    // Runs in O(log(n)) time.
+    void update(T x, P new_p)
     {
-        // TODO
-        // H[I[x]].second > new_p then decrease it
-        // bubbleUp() that pair
-        if (H[I[x]].second > new_p) 
-        {
-            H[I[x]].second = new_p; 
-            bubbleUp(I[x]);
-        }
+        int index = I.get(x);
+        P old_p = H[index].second;
+        H[index].second = new_p;
+        if (new_p < old_p)
+            bubbleUp(index);
+        else
+            bubbleDown(index);
+    }
+
+    // If x is in the MinPriorityQueue, removes it.
+    // Undefined behavior otherwise.
+    //
+    // Runs in O(log(n)) time.
+    void remove(T x)
+    {
+        int index = I.get(x);
+        pair<T, P> last = H.back();
+        H.pop_back();
+        if (index == (int)H.size())
+            return;
+        // Put the last element in the hole and sift it either way.
+        P old_p = H[index].second;
+        H[index] = last;
+        if (last.second < old_p)
+            bubbleUp(index);
+        else
+            bubbleDown(index);
     }
 };
 
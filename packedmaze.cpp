@@ -0,0 +1,304 @@
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "fdio.h"
+#include "packedmaze.h"
+
+using namespace std;
+
+// Helper function: rounds n up to the 8-byte boundary sections start on.
+static uint64_t aligned(uint64_t n) {
+    return (n + 7) & ~(uint64_t)7;
+}
+
+// Helper function: writes a section of n bytes and the zeros that
+// pad it to the next 8-byte boundary.
+static bool writeSection(int fd, const void *data, size_t n) {
+    static const char zeros[8] = {};
+    return writeFull(fd, data, n) && writeFull(fd, zeros, aligned(n) - n);
+}
+
+// Helper function: the bytes of the graph section of g.
+static uint64_t graphBytes(const MazeGraph &g) {
+    return (g.cellPos.size() + g.cellId.size() + g.offsets.size() + g.targets.size()) * sizeof(uint32_t)
+        + g.weights.size();
+}
+
+bool writePackedMaze(const char *path, string_view maze, bool withGraph) {
+    MazeGrid grid = parseMaze(maze);
+    if (grid.rows == 0)
+        return false;
+    MazeScan scan;
+    scanMaze(grid, scan);
+    MazeGraph g;
+    if (withGraph)
+        buildMazeGraph(grid, scan, g);
+
+    PackedMazeHeader h;
+    memset(&h, 0, sizeof h);
+    memcpy(h.magic, PACKED_MAZE_MAGIC, sizeof h.magic);
+    h.version = PACKED_MAZE_VERSION;
+    h.byteOrder = PACKED_MAZE_BYTE_ORDER;
+    h.rows = grid.rows;
+    h.cols = grid.cols;
+    h.wordsPerRow = scan.wordsPerRow;
+    h.start = scan.start;
+    h.goal = scan.goal;
+    memcpy(h.ends, scan.ends, sizeof h.ends);
+    h.hasGraph = withGraph;
+    if (withGraph) {
+        h.vertices = g.size();
+        h.edges = g.targets.size();
+        h.graphStart = g.start;
+        h.graphGoal = g.goal;
+    }
+    uint64_t textBytes = (uint64_t)grid.rows * grid.stride;
+    h.textOffset = aligned(sizeof h);
+    h.wallsOffset = h.textOffset + aligned(textBytes);
+    h.graphOffset = h.wallsOffset + aligned(scan.walls.size() * sizeof(uint64_t));
+    h.fileBytes = h.graphOffset + (withGraph ? aligned(graphBytes(g)) : 0);
+
+    int fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return false;
+    bool ok = writeSection(fd, &h, sizeof h)
+        && writeSection(fd, maze.data(), textBytes)
+        && writeSection(fd, scan.walls.data(), scan.walls.size() * sizeof(uint64_t));
+    if (ok && withGraph) {
+        // The graph arrays are written back to back, so only the
+        // weights at the end need padding.
+        static const char zeros[8] = {};
+        ok = writeFull(fd, g.cellPos.data(), g.cellPos.size() * sizeof(uint32_t))
+            && writeFull(fd, g.cellId.data(), g.cellId.size() * sizeof(uint32_t))
+            && writeFull(fd, g.offsets.data(), g.offsets.size() * sizeof(uint32_t))
+            && writeFull(fd, g.targets.data(), g.targets.size() * sizeof(uint32_t))
+            && writeFull(fd, g.weights.data(), g.weights.size())
+            && writeFull(fd, zeros, aligned(graphBytes(g)) - graphBytes(g));
+    }
+    return ::close(fd) == 0 && ok;
+}
+
+// Helper function: the cell id of the text offset of an open cell,
+// read from the graph's cellId array.
+static uint32_t graphIdOf(const PackedMazeHeader &h, const char *base, uint32_t offset) {
+    const uint32_t *cellId = (const uint32_t *)(base + h.graphOffset) + h.vertices;
+    return cellId[offset / (h.cols + 1) * h.cols + offset % (h.cols + 1)];
+}
+
+// Helper function: checks the cells the header names, with a few reads
+// each. The exits are both NONE, or distinct open boundary cells, the
+// goal set only with the start; a portal's ends are both NONE or two
+// distinct cells holding its digit. With a graph, the graph exits are
+// the ids of the text's, and every cell named is a vertex.
+static bool validCells(const PackedMazeHeader &h, const char *base) {
+    const char *text = base + h.textOffset;
+    const uint64_t *walls = (const uint64_t *)(base + h.wallsOffset);
+    uint64_t stride = (uint64_t)h.cols + 1;
+    uint64_t textBytes = h.rows * stride;
+    auto openCell = [&](uint32_t offset) {
+        if (offset >= textBytes)
+            return false;
+        uint64_t r = offset / stride, c = offset % stride;
+        return c < h.cols && text[offset] != '#' && text[offset] != '\n'
+            && !(walls[r * h.wordsPerRow + c / 64] >> (c % 64) & 1);
+    };
+    auto vertex = [&](uint32_t offset) { return !h.hasGraph || graphIdOf(h, base, offset) < h.vertices; };
+
+    const uint32_t NONE = MazeScan::NONE;
+    if (h.start == NONE && h.goal != NONE)
+        return false;
+    for (uint32_t exit : {h.start, h.goal}) {
+        if (exit == NONE)
+            continue;
+        uint64_t r = exit / stride, c = exit % stride;
+        if (!openCell(exit) || !vertex(exit) || !(r == 0 || r == h.rows - 1 || c == 0 || c == h.cols - 1))
+            return false;
+    }
+    if (h.start != NONE && h.start == h.goal)
+        return false;
+    for (int d = 0; d < 10; d++) {
+        const uint32_t *ends = h.ends[d];
+        if (ends[0] == NONE && ends[1] == NONE)
+            continue;
+        for (int i = 0; i < 2; i++) {
+            if (ends[i] == NONE || !openCell(ends[i]) || text[ends[i]] != '0' + d || !vertex(ends[i]))
+                return false;
+        }
+        if (ends[0] == ends[1])
+            return false;
+    }
+    if (h.hasGraph) {
+        auto idOf = [&](uint32_t offset) { return offset == NONE ? MazeGraph::NONE : graphIdOf(h, base, offset); };
+        if (h.graphStart != idOf(h.start) || h.graphGoal != idOf(h.goal))
+            return false;
+    }
+    return true;
+}
+
+// Helper function: checks that every row of the text ends with a
+// newline and that the wall bits past the last column are set.
+static bool validText(const PackedMazeHeader &h, const char *base) {
+    const char *text = base + h.textOffset;
+    const uint64_t *walls = (const uint64_t *)(base + h.wallsOffset);
+    uint64_t padding = h.cols % 64 ? ~0ull << h.cols % 64 : 0;
+    for (uint64_t r = 0; r < h.rows; r++) {
+        if (text[r * (h.cols + 1) + h.cols] != '\n')
+            return false;
+        if (h.wordsPerRow > 0 && (walls[(r + 1) * h.wordsPerRow - 1] & padding) != padding)
+            return false;
+    }
+    return true;
+}
+
+// Helper function: checks that the graph section is a well-formed
+// CSR graph whose ids and positions stay inside its arrays, with edge
+// costs of a digit at most.
+static bool validGraph(const PackedMazeHeader &h, const char *base) {
+    const uint32_t *cellPos = (const uint32_t *)(base + h.graphOffset);
+    uint64_t cells = (uint64_t)h.rows * h.cols;
+    const uint32_t *cellId = cellPos + h.vertices;
+    const uint32_t *offsets = cellId + cells;
+    const uint32_t *targets = offsets + h.vertices + 1;
+    const uint8_t *weights = (const uint8_t *)(targets + h.edges);
+    for (uint32_t v = 0; v < h.vertices; v++) {
+        if (cellPos[v] >= cells || cellId[cellPos[v]] != v)
+            return false;
+    }
+    for (uint64_t pos = 0; pos < cells; pos++) {
+        if (cellId[pos] != MazeGraph::NONE && cellId[pos] >= h.vertices)
+            return false;
+    }
+    if (offsets[0] != 0 || offsets[h.vertices] != h.edges)
+        return false;
+    for (uint32_t v = 0; v < h.vertices; v++) {
+        if (offsets[v] > offsets[v + 1])
+            return false;
+    }
+    for (uint32_t e = 0; e < h.edges; e++) {
+        if (targets[e] >= h.vertices || weights[e] > 9)
+            return false;
+    }
+    return true;
+}
+
+PackedMaze::~PackedMaze() {
+    close();
+}
+
+bool PackedMaze::open(const char *path) {
+    close();
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(PackedMazeHeader)) {
+        ::close(fd);
+        return false;
+    }
+    void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED)
+        return false;
+    base = (const char *)p;
+    length = st.st_size;
+
+    // Check the header, and that each section fits between its offset
+    // and the next.
+    const PackedMazeHeader &h = header();
+    uint64_t stride = (uint64_t)h.cols + 1;
+    uint64_t textBytes = h.rows * stride;
+    uint64_t wallBytes = (uint64_t)h.rows * h.wordsPerRow * sizeof(uint64_t);
+    uint64_t graphBytes = ((uint64_t)h.vertices * 2 + 1 + (uint64_t)h.rows * h.cols + h.edges) * sizeof(uint32_t)
+        + h.edges;
+    bool ok = memcmp(h.magic, PACKED_MAZE_MAGIC, sizeof h.magic) == 0
+        && h.version == PACKED_MAZE_VERSION
+        && h.byteOrder == PACKED_MAZE_BYTE_ORDER
+        && h.fileBytes == length
+        && h.rows > 0
+        && h.wordsPerRow == (h.cols + 63) / 64
+        && h.textOffset >= sizeof h && h.textOffset % 8 == 0
+        && h.wallsOffset >= h.textOffset + textBytes && h.wallsOffset % 8 == 0
+        && h.graphOffset >= h.wallsOffset + wallBytes && h.graphOffset % 8 == 0
+        && h.graphOffset + (h.hasGraph ? graphBytes : 0) <= length;
+    ok = ok && validCells(h, base);
+    if (!ok)
+        close();
+    return ok;
+}
+
+bool PackedMaze::verify() const {
+    const PackedMazeHeader &h = header();
+    return validText(h, base) && (!h.hasGraph || validGraph(h, base));
+}
+
+void PackedMaze::close() {
+    if (base)
+        munmap((void *)base, length);
+    base = nullptr;
+    length = 0;
+}
+
+string_view PackedMaze::text() const {
+    const PackedMazeHeader &h = header();
+    return string_view(base + h.textOffset, (size_t)h.rows * (h.cols + 1));
+}
+
+MazeGrid PackedMaze::grid() const {
+    const PackedMazeHeader &h = header();
+    MazeGrid grid;
+    grid.data = base + h.textOffset;
+    grid.rows = h.rows;
+    grid.cols = h.cols;
+    grid.stride = (size_t)h.cols + 1;
+    return grid;
+}
+
+void PackedMaze::loadScan(MazeScan &scan) const {
+    const PackedMazeHeader &h = header();
+    scan.start = h.start;
+    scan.goal = h.goal;
+    memcpy(scan.ends, h.ends, sizeof scan.ends);
+    scan.portals.clear();
+    for (int d = 0; d < 10; d++) {
+        if (h.ends[d][0] != MazeScan::NONE)
+            scan.portals.push_back({h.ends[d][0], h.ends[d][1], d});
+    }
+    scan.rows = h.rows;
+    scan.cols = h.cols;
+    scan.wordsPerRow = h.wordsPerRow;
+    scan.walls.view((const uint64_t *)(base + h.wallsOffset), (size_t)h.rows * h.wordsPerRow);
+}
+
+void PackedMaze::loadGraph(MazeGraph &g) const {
+    const PackedMazeHeader &h = header();
+    const uint32_t *p = (const uint32_t *)(base + h.graphOffset);
+    size_t cells = (size_t)h.rows * h.cols;
+    g.rows = h.rows;
+    g.cols = h.cols;
+    g.cellPos.view(p, h.vertices);
+    p += h.vertices;
+    g.cellId.view(p, cells);
+    p += cells;
+    g.offsets.view(p, h.vertices + 1);
+    p += h.vertices + 1;
+    g.targets.view(p, h.edges);
+    p += h.edges;
+    g.weights.view((const uint8_t *)p, h.edges);
+    g.start = h.graphStart;
+    g.goal = h.graphGoal;
+
+    // Portals are listed by graph id; the header has their offsets.
+    g.portals.clear();
+    for (int d = 0; d < 10; d++) {
+        if (h.ends[d][0] == MazeScan::NONE)
+            continue;
+        uint32_t ends[2];
+        for (int i = 0; i < 2; i++) {
+            uint32_t offset = h.ends[d][i];
+            ends[i] = g.cellId[offset / (h.cols + 1) * h.cols + offset % (h.cols + 1)];
+        }
+        g.portals.push_back({ends[0], ends[1], d});
+    }
+}
@@ -0,0 +1,115 @@
+#ifndef PACKEDMAZE_H
+#define PACKEDMAZE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include "mazegraph.h"
+#include "mazegrid.h"
+#include "mazescan.h"
+
+using namespace std;
+
+// A maze compiled to a binary file that loads without parsing.
+//
+// The file is a PackedMazeHeader followed by sections, each starting
+// on an 8-byte boundary at the offset the header gives:
+//
+// - text: the maze string, rows of cols chars and a newline, so the
+//   solution can be marked on a copy of it;
+// - walls: the MazeScan wall bitmap, rows * wordsPerRow words;
+// - graph (optional): the MazeGraph arrays cellPos, cellId, offsets,
+//   targets and weights, in that order.
+//
+// Integers are stored in the byte order of the machine that wrote the
+// file; a file from a machine of the other order fails to open.
+const char PACKED_MAZE_MAGIC[8] = {'M', 'A', 'Z', 'E', 'P', 'A', 'K', '\0'};
+const uint32_t PACKED_MAZE_VERSION = 1;
+const uint32_t PACKED_MAZE_BYTE_ORDER = 0x01020304;
+
+struct PackedMazeHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t rows;
+    uint32_t cols;
+    uint32_t wordsPerRow;
+    uint32_t start;         // Exits as offsets in the text, or MazeScan::NONE
+    uint32_t goal;
+    uint32_t ends[10][2];   // Portal ends by digit, as in MazeScan
+    uint32_t hasGraph;      // 1 if the graph section is present
+    uint32_t vertices;      // Graph sizes, 0 without a graph
+    uint32_t edges;
+    uint32_t graphStart;    // Exits as graph ids
+    uint32_t graphGoal;
+    uint32_t reserved;
+    uint64_t textOffset;
+    uint64_t wallsOffset;
+    uint64_t graphOffset;
+    uint64_t fileBytes;
+};
+
+// Compiles maze into a packed file at path, with the graph if
+// withGraph. Returns false if maze has no rows or the file cannot be
+// written.
+bool writePackedMaze(const char *path, string_view maze, bool withGraph);
+
+// A packed maze file, mapped into memory with a single mmap.
+//
+// open() does no work per cell: it checks the header, that every
+// section lies inside the file, and the handful of cells the header
+// names (the exits and portal ends). Loading then copies nothing:
+// grid() views the text in the mapping, and loadScan() and loadGraph()
+// point their arrays at the walls and graph sections.
+//
+// The searches trust the rest of the file: a row without its newline,
+// a missing wall padding bit, or an edge to a vertex that does not
+// exist sends them outside the arrays. A file that may be corrupt or
+// hostile should pass verify() before it is solved.
+class PackedMaze
+{
+    public:
+        PackedMaze() {}
+        ~PackedMaze();
+
+        PackedMaze(const PackedMaze &) = delete;
+        PackedMaze &operator=(const PackedMaze &) = delete;
+
+        // Maps the file at path. Returns false if it cannot be read or
+        // is not a well-formed packed maze of this version and byte
+        // order.
+        bool open(const char *path);
+
+        // Unmaps the file.
+        void close();
+
+        // Reads the whole file to check what open() leaves to trust:
+        // every row ends with a newline, the wall bits past the last
+        // column are set, and the graph, if any, is a CSR graph whose
+        // offsets, targets and cell ids stay inside its arrays, with
+        // edge costs of at most 9. Runs in O(s) time.
+        bool verify() const;
+
+        const PackedMazeHeader &header() const { return *(const PackedMazeHeader *)base; }
+
+        // The maze text, valid until close().
+        string_view text() const;
+        MazeGrid grid() const;
+
+        bool hasGraph() const { return header().hasGraph != 0; }
+
+        // Same as scanMaze(grid(), scan), with scan.walls viewing the
+        // mapping, so valid until close().
+        void loadScan(MazeScan &scan) const;
+
+        // Same as buildMazeGraph(grid(), g), with the arrays of g
+        // viewing the mapping, so valid until close(). Needs hasGraph().
+        void loadGraph(MazeGraph &g) const;
+
+    private:
+        const char *base = nullptr;
+        size_t length = 0;
+};
+
+#endif
@@ -0,0 +1,84 @@
+#include <sys/mman.h>
+#include <unistd.h>
+#include "pagedfile.h"
+
+using namespace std;
+
+PagedFile::~PagedFile() {
+    close();
+}
+
+bool PagedFile::open(int fd, uint64_t size, bool writable, size_t pageBytes, size_t maxPages) {
+    close();
+    long systemPage = sysconf(_SC_PAGESIZE);
+    if (fd < 0 || maxPages == 0 || pageBytes == 0 || (pageBytes & (pageBytes - 1)) != 0
+        || (systemPage > 0 && pageBytes % systemPage != 0))
+        return false;
+
+    this->fd = fd;
+    this->length = size;
+    this->writable = writable;
+    this->pageBytes = pageBytes;
+    this->maxPages = maxPages;
+    shift = 0;
+    while (((size_t)1 << shift) < pageBytes)
+        shift++;
+    mask = pageBytes - 1;
+    slotOf.assign((size + pageBytes - 1) / pageBytes, -1);
+    return true;
+}
+
+void PagedFile::close() {
+    for (Slot &s : slots)
+        munmap(s.base, pageBytes);
+    slots.clear();
+    slotOf.clear();
+    clock = 0;
+    lastPage = UINT64_MAX;
+    lastBase = nullptr;
+    fd = -1;
+    length = 0;
+}
+
+// Helper function: makes page the current page, mapping it if needed.
+char *PagedFile::map(uint64_t page, uint64_t offset) {
+    if (page >= slotOf.size())
+        return nullptr;
+
+    int slot = slotOf[page];
+    if (slot < 0) {
+        // Reuse the least recently used slot once the budget is spent.
+        if (slots.size() < maxPages) {
+            slot = slots.size();
+            slots.push_back({page, nullptr, 0});
+        } else {
+            slot = 0;
+            for (size_t i = 1; i < slots.size(); i++)
+                if (slots[i].lastUse < slots[slot].lastUse)
+                    slot = i;
+            munmap(slots[slot].base, pageBytes);
+            slotOf[slots[slot].page] = -1;
+        }
+
+        // The last page may be short; mapping past the end of the file
+        // is allowed as long as those bytes are never touched.
+        int prot = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+        void *base = mmap(nullptr, pageBytes, prot, MAP_SHARED, fd, (off_t)(page << shift));
+        if (base == MAP_FAILED) {
+            slots[slot] = slots.back();
+            if (slot != (int)slots.size() - 1)
+                slotOf[slots[slot].page] = slot;
+            slots.pop_back();
+            lastPage = UINT64_MAX;
+            return nullptr;
+        }
+        slots[slot].page = page;
+        slots[slot].base = (char *)base;
+        slotOf[page] = slot;
+    }
+
+    slots[slot].lastUse = ++clock;
+    lastPage = page;
+    lastBase = slots[slot].base;
+    return lastBase + (offset & mask);
+}
@@ -0,0 +1,75 @@
+#ifndef PAGEDFILE_H
+#define PAGEDFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// A window onto a file too large to map at once.
+//
+// The file is split into fixed-size pages, and only up to maxPages
+// of them are mapped at any time. Touching an unmapped page maps it,
+// unmapping the least recently used one first, so the resident memory
+// this class can pin is bounded by pageBytes * maxPages whatever the
+// file size. Writes go through a shared mapping, so they reach the
+// file when a page is unmapped.
+class PagedFile
+{
+    public:
+        PagedFile() {}
+        ~PagedFile();
+
+        PagedFile(const PagedFile &) = delete;
+        PagedFile &operator=(const PagedFile &) = delete;
+
+        // Starts paging the first size bytes of the open file fd.
+        // pageBytes must be a power of two and a multiple of the system
+        // page size. The PagedFile does not own fd.
+        // Returns false if the arguments are unusable.
+        bool open(int fd, uint64_t size, bool writable, size_t pageBytes, size_t maxPages);
+
+        // Unmaps every page.
+        void close();
+
+        uint64_t size() const { return length; }
+
+        // Returns the byte at offset, mapping its page if needed.
+        // The pointer stays valid until another page is mapped.
+        // Returns nullptr if the page cannot be mapped.
+        char *at(uint64_t offset)
+        {
+            uint64_t page = offset >> shift;
+            if (page != lastPage)
+                return map(page, offset);
+            return lastBase + (offset & mask);
+        }
+
+    private:
+        struct Slot
+        {
+            uint64_t page;
+            char *base;
+            uint64_t lastUse;
+        };
+
+        char *map(uint64_t page, uint64_t offset);
+
+        int fd = -1;
+        uint64_t length = 0;
+        bool writable = false;
+        size_t pageBytes = 0;
+        unsigned shift = 0;
+        uint64_t mask = 0;
+        size_t maxPages = 0;
+
+        vector<Slot> slots;
+        vector<int32_t> slotOf; // Slot holding each page, or -1
+        uint64_t clock = 0;
+
+        uint64_t lastPage = UINT64_MAX; // The most recently touched page
+        char *lastBase = nullptr;
+};
+
+#endif
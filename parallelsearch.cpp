@@ -0,0 +1,191 @@
+#include <atomic>
+#include <climits>
+#include <memory>
+#include <utility>
+#include "parallelsearch.h"
+
+using namespace std;
+
+static const int UNSEEN = INT_MAX;
+
+// Cells per chunk of a parallel pass. A bucket no bigger than this is
+// not worth waking the workers for.
+static const size_t GRAIN = 256;
+
+// Helper function: lowers dist to d if d is smaller, atomically.
+// Returns whether this call lowered it.
+static bool relax(atomic<int> &dist, int d) {
+    int old = dist.load(memory_order_relaxed);
+    while (d < old) {
+        if (dist.compare_exchange_weak(old, d, memory_order_relaxed))
+            return true;
+    }
+    return false;
+}
+
+bool deltaStepping(const MazeGraph &g, ThreadPool &pool, SearchScratch &s) {
+    return deltaStepping(g, pool, s, 1);
+}
+
+bool deltaStepping(const MazeGraph &g, ThreadPool &pool, SearchScratch &s, int delta) {
+    uint32_t n = g.size();
+    s.parent.assign(n, MazeGraph::NONE);
+    if (delta < 1)
+        delta = 1;
+
+    unique_ptr<atomic<int>[]> dist(new atomic<int>[n]);
+    pool.parallelFor(n, 1 << 16, [&](size_t begin, size_t end, int) {
+        for (size_t v = begin; v < end; v++)
+            dist[v].store(UNSEEN, memory_order_relaxed);
+    });
+
+    // Live costs lie between the start of the bucket being processed
+    // and its end plus the largest edge cost, so a circular array of
+    // maxWeight / delta + 2 buckets covers them.
+    int maxWeight = 1;
+    for (const PortalPair &p : g.portals)
+        maxWeight = max(maxWeight, p.cost);
+    int bucketCount = maxWeight / delta + 2;
+    vector< vector<uint32_t> > buckets(bucketCount);
+
+    // Per-worker output: cells whose cost a worker lowered, and the
+    // cells it took out of the current bucket.
+    int workers = pool.size();
+    vector< vector< pair<uint32_t, int> > > lowered(workers);
+    vector< vector<uint32_t> > settled(workers);
+    vector<uint32_t> frontier;
+    size_t queued = 0;
+
+    // Helper: files every lowered cost into its bucket, skipping ones
+    // another worker has since lowered further.
+    auto collect = [&]() {
+        for (vector< pair<uint32_t, int> > &out : lowered) {
+            for (const pair<uint32_t, int> &entry : out) {
+                if (dist[entry.first].load(memory_order_relaxed) == entry.second) {
+                    buckets[(entry.second / delta) % bucketCount].push_back(entry.first);
+                    queued++;
+                    s.counters.push(queued);
+                }
+            }
+            out.clear();
+        }
+    };
+
+    dist[g.start].store(0);
+    buckets[0].push_back(g.start);
+    queued = 1;
+    s.counters.push(1);
+    for (long long i = 0; queued > 0; i++) {
+        vector<uint32_t> &bucket = buckets[i % bucketCount];
+
+        // A narrow bucket is processed on the caller alone, each cell's
+        // edges relaxed straight into the buckets as it comes out, so
+        // a long run of narrow levels (a corridor) costs about what a
+        // serial bucket queue would. A cell lowered again within the
+        // bucket comes out again and relaxes its edges anew.
+        if (bucket.size() <= GRAIN || workers == 1) {
+            while (!bucket.empty()) {
+                uint32_t v = bucket.back();
+                bucket.pop_back();
+                queued--;
+                s.counters.pop(1);
+                int d = dist[v].load(memory_order_relaxed);
+                if (d / delta != i)
+                    continue;
+                s.counters.settle(1);
+                for (uint32_t e = g.offsets[v]; e < g.offsets[v + 1]; e++) {
+                    // No other thread is running, so no compare-and-swap.
+                    atomic<int> &target = dist[g.targets[e]];
+                    int to = d + g.weights[e];
+                    if (to < target.load(memory_order_relaxed)) {
+                        target.store(to, memory_order_relaxed);
+                        buckets[(to / delta) % bucketCount].push_back(g.targets[e]);
+                        queued++;
+                        s.counters.push(queued);
+                    }
+                }
+            }
+            int goalCost = dist[g.goal].load(memory_order_relaxed);
+            if (goalCost != UNSEEN && goalCost / delta <= i)
+                break;
+            continue;
+        }
+
+        for (vector<uint32_t> &list : settled)
+            list.clear();
+
+        // Relax light edges until the bucket stays empty.
+        while (!bucket.empty()) {
+            frontier.swap(bucket);
+            bucket.clear();
+            queued -= frontier.size();
+            s.counters.pop(frontier.size());
+            pool.parallelFor(frontier.size(), GRAIN, [&](size_t begin, size_t end, int worker) {
+                for (size_t k = begin; k < end; k++) {
+                    uint32_t v = frontier[k];
+                    int d = dist[v].load(memory_order_relaxed);
+                    if (d / delta != i)
+                        continue; // Moved to an earlier bucket and handled there.
+                    settled[worker].push_back(v);
+                    for (uint32_t e = g.offsets[v]; e < g.offsets[v + 1]; e++) {
+                        int w = g.weights[e];
+                        if (w <= delta && relax(dist[g.targets[e]], d + w))
+                            lowered[worker].push_back({g.targets[e], d + w});
+                    }
+                }
+            });
+            collect();
+        }
+
+        // Then the heavy edges of everything the bucket settled.
+        frontier.clear();
+        for (vector<uint32_t> &list : settled) {
+            frontier.insert(frontier.end(), list.begin(), list.end());
+            s.counters.settle(list.size());
+        }
+        pool.parallelFor(frontier.size(), GRAIN, [&](size_t begin, size_t end, int worker) {
+            for (size_t k = begin; k < end; k++) {
+                uint32_t v = frontier[k];
+                int d = dist[v].load(memory_order_relaxed);
+                for (uint32_t e = g.offsets[v]; e < g.offsets[v + 1]; e++) {
+                    int w = g.weights[e];
+                    if (w > delta && relax(dist[g.targets[e]], d + w))
+                        lowered[worker].push_back({g.targets[e], d + w});
+                }
+            }
+        });
+        collect();
+
+        // Buckets are final once processed, so the goal can be read as
+        // soon as its bucket is done.
+        int goalCost = dist[g.goal].load(memory_order_relaxed);
+        if (goalCost != UNSEEN && goalCost / delta <= i)
+            break;
+    }
+
+    if (dist[g.goal].load() == UNSEEN)
+        return false;
+
+    // Walk back from the goal to a neighbor whose cost plus the edge
+    // gives the cell's cost. Edges run both ways, so the edges out of a
+    // cell are also its incoming edges. Positive edges are preferred:
+    // following a '0' portal first could bounce between its two ends.
+    for (uint32_t v = g.goal; v != g.start; v = s.parent[v]) {
+        int d = dist[v].load(memory_order_relaxed);
+        uint32_t viaZero = MazeGraph::NONE;
+        for (uint32_t e = g.offsets[v]; e < g.offsets[v + 1]; e++) {
+            uint32_t u = g.targets[e];
+            int du = dist[u].load(memory_order_relaxed);
+            if (du != UNSEEN && du + g.weights[e] == d) {
+                if (g.weights[e] > 0) {
+                    s.parent[v] = u;
+                    break;
+                }
+                viaZero = u;
+            }
+        }
+        if (s.parent[v] == MazeGraph::NONE)
+            s.parent[v] = viaZero;
+    }
+    return true;
+}
@@ -0,0 +1,32 @@
+#ifndef PARALLELSEARCH_H
+#define PARALLELSEARCH_H
+
+#include "mazegraph.h"
+#include "search.h"
+#include "threadpool.h"
+
+using namespace std;
+
+// Delta-stepping: a parallel shortest-path search from g.start to g.goal.
+//
+// Cells are kept in buckets of width delta by tentative cost. All cells
+// of the lowest bucket are relaxed at once across the pool: first their
+// light edges (cost <= delta), repeatedly, until the bucket stops
+// changing, then their heavy edges. Costs are updated with atomic
+// minimums, so the result is the exact shortest cost whatever the
+// interleaving. Parents are recovered afterwards from the final costs,
+// so the path is the same on every run.
+//
+// With delta = 1, which the unit adjacent moves make the natural
+// choice, each bucket holds a single cost: only '0' portals ever send a
+// cell back into the bucket being processed, and no work is repeated.
+// A bucket of a few hundred cells or fewer, the common case along
+// corridors, is processed on the calling thread alone, as is every
+// bucket on a pool of one worker.
+//
+// Fills s.parent along the path and returns whether the goal was
+// reached, like the searches in search.h.
+bool deltaStepping(const MazeGraph &g, ThreadPool &pool, SearchScratch &s);
+bool deltaStepping(const MazeGraph &g, ThreadPool &pool, SearchScratch &s, int delta);
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef PATHOUT_H
+#define PATHOUT_H
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+// Where a solve puts the cells of the path it found, each named by its
+// offset in the maze string: marked with 'o' in a copy of the maze, or
+// listed in order, for callers that want the route without the solved
+// maze. The searches walk their paths back from the goal, so listed
+// cells come goal first.
+class PathOut
+{
+    public:
+        PathOut(char *solution) : solution(solution) {}
+        PathOut(vector<uint32_t> &cells) : cells(&cells) {}
+
+        // Starts a solve of maze: copies it into the solution, so an
+        // unsolved maze comes back as it is, or empties the list.
+        void begin(string_view maze)
+        {
+            if (cells)
+                cells->clear();
+            else if (solution != maze.data())
+                memcpy(solution, maze.data(), maze.size());
+        }
+
+        void add(uint32_t cell)
+        {
+            if (cells)
+                cells->push_back(cell);
+            else
+                solution[cell] = 'o';
+        }
+
+    private:
+        char *solution = nullptr;
+        vector<uint32_t> *cells = nullptr;
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef PORTALHEURISTIC_H
+#define PORTALHEURISTIC_H
+
+#include <climits>
+#include <cstdlib>
+#include <vector>
+
+using namespace std;
+
+// A lower bound on the cost from any cell to the goal, for A*.
+//
+// A path with no portal jump costs at least the Manhattan distance.
+// A path with jumps walks to some portal cell, pays for at least one
+// jump, and walks to the goal from some portal cell. Each term changes
+// by at most 1 per adjacent move and the portal term absorbs every
+// jump, so the estimate is consistent and A* never reopens a cell.
+// Cells are given as (row, col).
+class PortalHeuristic
+{
+    public:
+        PortalHeuristic(int goalRow, int goalCol) : goalRow(goalRow), goalCol(goalCol)
+        {
+        }
+
+        // Adds the portal joining two cells at the given cost.
+        void addPortal(int row1, int col1, int row2, int col2, int cost)
+        {
+            cheapest = min(cheapest, cost);
+            rows.push_back(row1);
+            cols.push_back(col1);
+            rows.push_back(row2);
+            cols.push_back(col2);
+            toGoal = min(toGoal, min(distance(row1, col1, goalRow, goalCol),
+                                     distance(row2, col2, goalRow, goalCol)));
+            viaPortal = cheapest + toGoal;
+        }
+
+        int operator()(int r, int c) const
+        {
+            int h = distance(r, c, goalRow, goalCol);
+            if (viaPortal >= h)
+                return h;
+            for (size_t i = 0; i < rows.size(); i++) {
+                int bound = distance(r, c, rows[i], cols[i]) + viaPortal;
+                if (bound < h)
+                    h = bound;
+            }
+            return h;
+        }
+
+    private:
+        static int distance(int r1, int c1, int r2, int c2)
+        {
+            return abs(r1 - r2) + abs(c1 - c2);
+        }
+
+        int goalRow, goalCol;
+        int cheapest = INT_MAX;
+        int toGoal = INT_MAX;
+        int viaPortal = INT_MAX; // Cheapest jump plus the walk from a portal to the goal
+        vector<int> rows, cols; // Portal cell positions
+};
+
+#endif
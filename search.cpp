@@ -0,0 +1,133 @@
+#include <climits>
+#include "portalheuristic.h"
+#include "search.h"
+
+using namespace std;
+
+static const int UNSEEN = INT_MAX;
+
+bool dijkstraHeap(const MazeGraph &g, SearchScratch &s) {
+    pmr::vector<int> &costSoFar = s.costSoFar;
+    pmr::vector<uint32_t> &parent = s.parent;
+    costSoFar.assign(g.size(), UNSEEN);
+    parent.assign(g.size(), MazeGraph::NONE);
+    MinPriorityQueue<uint32_t, 4> &frontier = s.heap;
+    frontier.clear();
+    frontier.reserve(g.size());
+    frontier.push(g.start, 0);
+    s.counters.push(1);
+    costSoFar[g.start] = 0;
+
+    while (frontier.size() > 0) {
+        uint32_t current = frontier.front();
+        frontier.pop();
+        s.counters.pop();
+        s.counters.settle();
+        int currentCost = costSoFar[current];
+
+        if (current == g.goal)
+            return true;
+
+        // Explore each neighbor.
+        for (uint32_t e = g.offsets[current]; e < g.offsets[current + 1]; e++) {
+            uint32_t next = g.targets[e];
+            int newCost = currentCost + g.weights[e];
+            if (costSoFar[next] == UNSEEN) {
+                costSoFar[next] = newCost;
+                parent[next] = current;
+                frontier.push(next, newCost);
+                s.counters.push(frontier.size());
+            } else if (newCost < costSoFar[next]) {
+                costSoFar[next] = newCost;
+                parent[next] = current;
+                frontier.decrease_key(next, newCost);
+                s.counters.decreaseKey();
+            }
+        }
+    }
+    return false;
+}
+
+bool dijkstraBucket(const MazeGraph &g, SearchScratch &s) {
+    pmr::vector<int> &costSoFar = s.costSoFar;
+    pmr::vector<uint32_t> &parent = s.parent;
+    costSoFar.assign(g.size(), UNSEEN);
+    parent.assign(g.size(), MazeGraph::NONE);
+    BucketQueue<uint32_t> &frontier = s.buckets;
+    frontier.clear();
+    frontier.push(g.start, 0);
+    s.counters.push(1);
+    costSoFar[g.start] = 0;
+
+    while (frontier.size() > 0) {
+        int currentCost = frontier.frontPriority();
+        uint32_t current = frontier.front();
+        frontier.pop();
+        s.counters.pop();
+
+        // Skip entries left behind by a later, cheaper push.
+        if (currentCost > costSoFar[current])
+            continue;
+        s.counters.settle();
+
+        if (current == g.goal)
+            return true;
+
+        for (uint32_t e = g.offsets[current]; e < g.offsets[current + 1]; e++) {
+            uint32_t next = g.targets[e];
+            int newCost = currentCost + g.weights[e];
+            if (newCost < costSoFar[next]) {
+                costSoFar[next] = newCost;
+                parent[next] = current;
+                frontier.push(next, newCost);
+                s.counters.push(frontier.size());
+            }
+        }
+    }
+    return false;
+}
+
+bool astar(const MazeGraph &g, SearchScratch &s) {
+    PortalHeuristic estimate(g.row(g.goal), g.col(g.goal));
+    for (const PortalPair &p : g.portals)
+        estimate.addPortal(g.row(p.a), g.col(p.a), g.row(p.b), g.col(p.b), p.cost);
+    auto h = [&](uint32_t v) { return estimate(g.row(v), g.col(v)); };
+    pmr::vector<int> &costSoFar = s.costSoFar;
+    pmr::vector<uint32_t> &parent = s.parent;
+    costSoFar.assign(g.size(), UNSEEN);
+    parent.assign(g.size(), MazeGraph::NONE);
+    MinPriorityQueue<uint32_t, 4> &frontier = s.heap;
+    frontier.clear();
+    frontier.reserve(g.size());
+    frontier.push(g.start, h(g.start));
+    s.counters.push(1);
+    costSoFar[g.start] = 0;
+
+    while (frontier.size() > 0) {
+        uint32_t current = frontier.front();
+        frontier.pop();
+        s.counters.pop();
+        s.counters.settle();
+        int currentCost = costSoFar[current];
+
+        if (current == g.goal)
+            return true;
+
+        for (uint32_t e = g.offsets[current]; e < g.offsets[current + 1]; e++) {
+            uint32_t next = g.targets[e];
+            int newCost = currentCost + g.weights[e];
+            if (costSoFar[next] == UNSEEN) {
+                costSoFar[next] = newCost;
+                parent[next] = current;
+                frontier.push(next, newCost + h(next));
+                s.counters.push(frontier.size());
+            } else if (newCost < costSoFar[next]) {
+                costSoFar[next] = newCost;
+                parent[next] = current;
+                frontier.decrease_key(next, newCost + h(next));
+                s.counters.decreaseKey();
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,80 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include "bucketqueue.h"
+#include "mazegraph.h"
+#include "minpriorityqueue.h"
+#include "solvestats.h"
+
+using namespace std;
+
+// Buffers the searches work in. Keeping one around between solves
+// lets repeated searches reuse the memory instead of reallocating.
+// Everything is allocated from the given memory resource.
+class SearchScratch
+{
+    public:
+        SearchScratch() : SearchScratch(pmr::get_default_resource()) {}
+        SearchScratch(pmr::memory_resource *memory) :
+            costSoFar(memory), parent(memory), heap(memory), buckets(memory),
+            arrived(memory), expanded(memory), unseen(memory), front(memory),
+            next(memory), level{pmr::vector<uint64_t>(memory), pmr::vector<uint64_t>(memory)},
+            frontWords(memory), nextWords(memory), narrowCost(memory), parentCodes(memory),
+            settled(memory), narrowLinks(memory), wideLinks(memory)
+        {
+        }
+
+        pmr::vector<int> costSoFar;
+        pmr::vector<uint32_t> parent;
+        MinPriorityQueue<uint32_t, 4> heap;
+        BucketQueue<uint32_t> buckets;
+
+        // Directions each cell was reached and expanded in, for jumpPointSearch
+        pmr::vector<uint8_t> arrived, expanded;
+
+        // Bitmaps and active word lists for bitParallelBfs
+        pmr::vector<uint64_t> unseen, front, next, level[2];
+        pmr::vector<uint32_t> frontWords, nextWords;
+
+        // Compact state for the searches over offsets: 16-bit costs
+        // where fitsNarrow(), packed ParentCodes, and a bit per settled cell
+        pmr::vector<uint16_t> narrowCost;
+        pmr::vector<uint8_t> parentCodes;
+        pmr::vector<uint64_t> settled;
+
+        // Bucket links for kernelSearch, by offset width
+        pmr::vector<uint16_t> narrowLinks;
+        pmr::vector<uint32_t> wideLinks;
+
+        // What the last search did; empty unless built with MAZE_STATS
+        SearchCounters counters;
+};
+
+// Shortest-path searches from g.start to g.goal.
+//
+// Each one fills s.parent with the predecessor of every cell it
+// reached (MazeGraph::NONE for the start and for unreached cells)
+// and returns whether the goal was reached.
+
+// Dijkstra's algorithm with a 4-ary MinPriorityQueue.
+//
+// Runs in O(E*log(V)) time.
+bool dijkstraHeap(const MazeGraph &g, SearchScratch &s);
+
+// Dijkstra's algorithm with a BucketQueue, using the fact that
+// every edge costs 0 to 9.
+//
+// Runs in O(V + E) time.
+bool dijkstraBucket(const MazeGraph &g, SearchScratch &s);
+
+// A* with a heuristic that stays admissible and consistent with
+// portals: the Manhattan distance to the goal, or, if smaller, the
+// distance to the nearest portal cell plus the cheapest portal cost
+// plus the distance from the portal cell nearest the goal.
+// Returns a path of the same cost as dijkstraHeap while settling
+// only the cells whose estimate is below the shortest path cost.
+//
+// Runs in O(E*log(V)) time.
+bool astar(const MazeGraph &g, SearchScratch &s);
+
+#endif
@@ -3,8 +3,10 @@
 #define SOLVE_H
 
 #include <string>
+#include <string_view>
 #include <unordered_set>
 #include "minpriorityqueue.h" // Includes <vector>, <unordered_map>, <utility>
+#include "solvestats.h"
 
 using namespace std;
 
@@ -23,7 +25,48 @@ using namespace std;
 // Undefined behavior if the maze is not valid or has no solution.
 //
 // Must run in O(s*log(s)) time.
-string solve(string maze);
+string solve(string_view maze);
+
+// Shortest-path engines that solve() can use.
+enum SolveEngine
+{
+    ENGINE_HEAP,     // Dijkstra with MinPriorityQueue
+    ENGINE_BUCKET,   // Dijkstra with a BucketQueue over the 0-9 edge costs
+    ENGINE_ASTAR,    // A* with a portal-aware Manhattan heuristic
+    ENGINE_IMPLICIT, // Dijkstra on the maze bytes, with no graph built
+    ENGINE_PARALLEL, // Delta-stepping on all cores, for very large mazes
+    ENGINE_BITBFS,   // Bit-parallel BFS on row bitmaps; ENGINE_HEAP if there are portals
+    ENGINE_JPS,      // Jump point search, skipping straight runs of open cells
+    ENGINE_AUTO,     // A kernel specialized for the maze's size and portals
+    ENGINE_CORRIDOR  // Dijkstra on junctions, after filling dead ends and contracting corridors
+};
+
+const int ENGINE_COUNT = ENGINE_CORRIDOR + 1;
+
+// Name of an engine as the command-line tools take it ("heap",
+// "bucket", ..., "corridor"), and the reverse lookup;
+// parseSolveEngine returns false for unknown names.
+const char *solveEngineName(SolveEngine engine);
+bool parseSolveEngine(const string &name, SolveEngine &engine);
+
+// solve(maze) uses ENGINE_AUTO: breadth-first search on bitboards for
+// mazes without portals, Dial's buckets for mazes with them.
+//
+// Same as solve(maze), using the given engine.
+// Every engine returns a shortest solution.
+string solve(string_view maze, SolveEngine engine);
+
+// Writes the solution of maze into out, which must have room for
+// maze.size() chars, without building any intermediate copy.
+// out may be maze.data() to mark the path in place.
+// Returns whether a solution was found; if not, out holds the maze.
+bool solveInto(string_view maze, char *out);
+bool solveInto(string_view maze, char *out, SolveEngine engine);
+
+// Same as solveInto(maze, out, engine), also filling in stats with
+// the time spent in each phase and the work the search did. stats is
+// all zeros unless the solver was built with MAZE_STATS.
+bool solveInto(string_view maze, char *out, SolveEngine engine, SolveStats *stats);
 
 #endif 
 
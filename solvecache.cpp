@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <cstring>
+#include "solvecache.h"
+
+using namespace std;
+
+static const uint64_t PRIME1 = 0x9E3779B97F4A7C15ull;
+static const uint64_t PRIME2 = 0xBF58476D1CE4E5B9ull;
+static const uint64_t PRIME3 = 0x94D049BB133111EBull;
+
+// Bytes charged to each entry for its list node, index slot and headers.
+static const size_t ENTRY_OVERHEAD = 128;
+
+// Helper function: mixes the bits of x so that each affects all of them.
+static uint64_t mix(uint64_t x) {
+    x = (x ^ (x >> 30)) * PRIME2;
+    x = (x ^ (x >> 27)) * PRIME3;
+    return x ^ (x >> 31);
+}
+
+// Helper function: a 64-bit hash of n bytes. Four independent lanes
+// each take a word of every 32 bytes, so the multiplies overlap.
+static uint64_t hashBytes(const char *p, size_t n) {
+    uint64_t lane[4] = {PRIME1, PRIME2, PRIME3, n};
+    const char *end = p + n;
+    for (; end - p >= 32; p += 32) {
+        for (int i = 0; i < 4; i++) {
+            uint64_t w;
+            memcpy(&w, p + 8 * i, 8);
+            lane[i] = (lane[i] ^ w) * PRIME1;
+            lane[i] ^= lane[i] >> 29;
+        }
+    }
+    uint64_t h = mix(lane[0]) ^ mix(lane[1] + PRIME1) ^ mix(lane[2] + PRIME2) ^ mix(lane[3] + PRIME3);
+    for (; end - p >= 8; p += 8) {
+        uint64_t w;
+        memcpy(&w, p, 8);
+        h = mix(h ^ w);
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, p, end - p);
+    return mix(h ^ tail ^ (uint64_t)(end - p) << 56);
+}
+
+size_t SolveCache::Entry::bytes() const {
+    return maze.size() + path.size() * sizeof(uint32_t) + ENTRY_OVERHEAD;
+}
+
+SolveCache::SolveCache(size_t capacity) : SolveCache(capacity, 16) {
+}
+
+SolveCache::SolveCache(size_t capacity, int shardCount) {
+    shardCount = max(shardCount, 1);
+    shardCapacity = capacity / shardCount;
+    for (int i = 0; i < shardCount; i++)
+        shards.emplace_back(new Shard());
+}
+
+// Helper function: the shard that holds mazes with the given hash.
+// The low bits pick the bucket in the shard's index, so the shard is
+// picked by the high ones.
+SolveCache::Shard &SolveCache::shardOf(uint64_t hash) {
+    return *shards[(hash >> 40) % shards.size()];
+}
+
+// Helper function: drops least recently used entries of shard until it
+// fits its share. The caller holds the shard's lock.
+void SolveCache::evict(Shard &shard) {
+    while (shard.bytes > shardCapacity && !shard.recent.empty()) {
+        Entry &oldest = shard.recent.back();
+        auto range = shard.index.equal_range(oldest.hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (&*it->second == &oldest) {
+                shard.index.erase(it);
+                break;
+            }
+        }
+        shard.bytes -= oldest.bytes();
+        shard.recent.pop_back();
+        shard.counts.evictions++;
+    }
+}
+
+bool SolveCache::lookup(string_view maze, char *out, bool &found) {
+    return find(hashBytes(maze.data(), maze.size()), maze, out, found);
+}
+
+void SolveCache::insert(string_view maze, const char *solution, bool found) {
+    store(hashBytes(maze.data(), maze.size()), maze, solution, found);
+}
+
+// Helper function: lookup() for a maze with the given hash.
+bool SolveCache::find(uint64_t hash, string_view maze, char *out, bool &found) {
+    Shard &shard = shardOf(hash);
+    lock_guard<mutex> guard(shard.lock);
+    auto range = shard.index.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        list<Entry>::iterator entry = it->second;
+        if (entry->maze != maze)
+            continue;
+
+        // The maze is the solution but for the path cells.
+        if (out != maze.data())
+            memcpy(out, maze.data(), maze.size());
+        for (uint32_t cell : entry->path)
+            out[cell] = 'o';
+        found = entry->found;
+        shard.recent.splice(shard.recent.begin(), shard.recent, entry);
+        shard.counts.hits++;
+        return true;
+    }
+    shard.counts.misses++;
+    return false;
+}
+
+// Helper function: insert() for a maze with the given hash.
+void SolveCache::store(uint64_t hash, string_view maze, const char *solution, bool found) {
+    // Size the entry before building it, so one too big for its shard
+    // is turned away without allocating.
+    if (maze.size() + ENTRY_OVERHEAD > shardCapacity)
+        return;
+    size_t pathCells = 0;
+    for (size_t i = 0; i < maze.size(); i++)
+        pathCells += solution[i] != maze[i];
+    if (maze.size() + pathCells * sizeof(uint32_t) + ENTRY_OVERHEAD > shardCapacity)
+        return;
+
+    Entry entry;
+    entry.hash = hash;
+    entry.found = found;
+    entry.path.reserve(pathCells);
+    for (size_t i = 0; i < maze.size(); i++) {
+        if (solution[i] != maze[i])
+            entry.path.push_back(i);
+    }
+    entry.maze.assign(maze);
+
+    Shard &shard = shardOf(entry.hash);
+    lock_guard<mutex> guard(shard.lock);
+    auto range = shard.index.equal_range(entry.hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second->maze == maze)
+            return;
+    }
+    shard.bytes += entry.bytes();
+    shard.recent.push_front(move(entry));
+    shard.index.emplace(shard.recent.front().hash, shard.recent.begin());
+    evict(shard);
+}
+
+bool SolveCache::solveInto(MazeSolver &solver, string_view maze, char *out, SolveEngine engine) {
+    uint64_t hash = hashBytes(maze.data(), maze.size());
+    bool found;
+    if (find(hash, maze, out, found))
+        return found;
+
+    // Solving in place overwrites the maze, so keep a copy to cache
+    // it under.
+    string copy;
+    if (out == maze.data()) {
+        copy.assign(maze);
+        maze = copy;
+    }
+    found = solver.solveInto(maze, out, engine);
+    store(hash, maze, out, found);
+    return found;
+}
+
+SolveCacheStats SolveCache::stats() const {
+    SolveCacheStats total;
+    for (const unique_ptr<Shard> &shard : shards) {
+        lock_guard<mutex> guard(shard->lock);
+        total.hits += shard->counts.hits;
+        total.misses += shard->counts.misses;
+        total.evictions += shard->counts.evictions;
+        total.entries += shard->recent.size();
+        total.bytes += shard->bytes;
+    }
+    return total;
+}
+
+void SolveCache::clear() {
+    for (unique_ptr<Shard> &shard : shards) {
+        lock_guard<mutex> guard(shard->lock);
+        shard->recent.clear();
+        shard->index.clear();
+        shard->bytes = 0;
+    }
+}
@@ -0,0 +1,98 @@
+#ifndef SOLVECACHE_H
+#define SOLVECACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "mazesolver.h"
+
+using namespace std;
+
+// What a SolveCache has done since it was made, for sizing it.
+struct SolveCacheStats
+{
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    size_t entries = 0; // Solutions held now
+    size_t bytes = 0;   // Bytes they are charged, of at most capacity
+};
+
+// Remembers the solutions of recently solved mazes, so a maze sent
+// again byte for byte is answered without being solved.
+//
+// Mazes are found by a 64-bit hash of their bytes and confirmed by
+// comparing every byte, so a collision costs a comparison, never a
+// wrong answer. An entry keeps the maze and the offsets of its path
+// cells, and is charged those bytes plus a fixed overhead. Once the
+// total passes the capacity, the least recently used entries go.
+//
+// The cache is split into shards by hash, each with its own lock,
+// list and capacity share, so threads looking up different mazes
+// rarely wait on each other. Safe to share between threads.
+class SolveCache
+{
+    public:
+        // Holds at most capacity bytes, in 16 shards or the given number.
+        SolveCache(size_t capacity);
+        SolveCache(size_t capacity, int shards);
+
+        SolveCache(const SolveCache &) = delete;
+        SolveCache &operator=(const SolveCache &) = delete;
+
+        // If maze is cached, writes its solution into out, which must
+        // have room for maze.size() chars and may be maze.data(), sets
+        // found to whether it has a path, and returns true. Otherwise
+        // returns false and leaves out alone.
+        bool lookup(string_view maze, char *out, bool &found);
+
+        // Caches solution, the maze with its path marked, or the maze
+        // unchanged if found is false. A maze too big for one shard's
+        // share is not cached.
+        void insert(string_view maze, const char *solution, bool found);
+
+        // Same as solver.solveInto(maze, out, engine), answering from
+        // the cache when it can and caching what it solves.
+        bool solveInto(MazeSolver &solver, string_view maze, char *out, SolveEngine engine);
+
+        SolveCacheStats stats() const;
+
+        // Drops every entry; the counters are kept.
+        void clear();
+
+    private:
+        struct Entry
+        {
+            uint64_t hash;
+            string maze;
+            vector<uint32_t> path; // Offsets marked 'o'
+            bool found;
+
+            size_t bytes() const;
+        };
+
+        struct Shard
+        {
+            mutable mutex lock;
+            list<Entry> recent; // Most recently used first
+            unordered_multimap<uint64_t, list<Entry>::iterator> index;
+            size_t bytes = 0;
+            SolveCacheStats counts;
+        };
+
+        Shard &shardOf(uint64_t hash);
+        bool find(uint64_t hash, string_view maze, char *out, bool &found);
+        void store(uint64_t hash, string_view maze, const char *solution, bool found);
+        void evict(Shard &shard);
+
+        size_t shardCapacity;
+        vector< unique_ptr<Shard> > shards;
+};
+
+#endif
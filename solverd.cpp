@@ -0,0 +1,348 @@
+// A long-running maze solver that serves a stream of requests.
+//
+// Build it like the tests, with solverd.cpp in place of main.cpp:
+//     g++ -O2 -pthread solverd.cpp <every other .cpp but main.cpp and bench.cpp> -o solverd
+//
+// Usage:
+//     solverd [--threads N] [--engine heap|bucket|astar|implicit|parallel|bitbfs|jps|auto|corridor]
+//             [--cache BYTES] [--socket PATH]
+//
+// Without --socket it serves one stream on stdin and stdout and exits
+// at end of input. With --socket it listens on a Unix domain socket at
+// PATH and serves every connection, each as its own stream, until it
+// is killed.
+//
+// Protocol: a request is a 4-byte little-endian length followed by
+// that many bytes of maze. A response is a 4-byte little-endian
+// length, one byte that is 1 if a path was found and 0 if not, and
+// then the solution, which is the maze unchanged when there is no
+// path. Responses come back in request order. A stream ends at end of
+// input; a request cut short or longer than 1 GiB also ends it.
+//
+// Requests are pipelined. A reader thread per stream frames requests
+// and queues them, a fixed pool of solver threads takes them in turn,
+// and a writer thread per stream sends the responses as they come due.
+// The solver threads start with the process, each with its own
+// MazeSolver whose buffers are warmed on a generated maze, so a client
+// that keeps a few requests in flight pays for little but the solves.
+//
+// With --cache, the solver threads share a SolveCache of that many
+// bytes, and a maze sent again byte for byte is answered from it.
+// The hit and miss counts go to stderr when a stream ends.
+
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "fdio.h"
+#include "mazegen.h"
+#include "mazesolver.h"
+#include "solve.h"
+#include "solvecache.h"
+
+using namespace std;
+
+static const uint32_t MAX_REQUEST = 1u << 30;
+
+// Helper function: reads exactly n bytes. Returns false at end of
+// input or on an error.
+static bool readFull(int fd, char *p, size_t n) {
+    while (n > 0) {
+        ssize_t got = read(fd, p, n);
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got <= 0)
+            return false;
+        p += got;
+        n -= got;
+    }
+    return true;
+}
+
+// The responses of one stream, written in request order.
+//
+// Solver threads hand in answers in whatever order they finish; the
+// writer thread sends each one once everything before it has gone
+// out. The reader keeps at most window requests ahead of the writer,
+// so a client that stops reading stops the stream instead of piling
+// up answers.
+class Stream
+{
+    public:
+        Stream(int fd, uint64_t window) : out(fd), window(window) {}
+
+        // Waits until request seq may be queued. Returns false if the
+        // client has gone away.
+        bool admit(uint64_t seq)
+        {
+            unique_lock<mutex> hold(lock);
+            room.wait(hold, [&]() { return seq - written < window || failed; });
+            return !failed;
+        }
+
+        // Hands in the answer to request seq.
+        void finish(uint64_t seq, string &&solution, bool found)
+        {
+            lock_guard<mutex> hold(lock);
+            done[seq] = {move(solution), found};
+            ready.notify_one();
+        }
+
+        // Says that count requests were queued in all.
+        void close(uint64_t count)
+        {
+            lock_guard<mutex> hold(lock);
+            total = count;
+            ready.notify_one();
+        }
+
+        // Writer thread: sends the answers in order until all of them
+        // have come in. After a failed write the rest are dropped, but
+        // still waited for, since solver threads may hold this Stream.
+        void writeAll()
+        {
+            unique_lock<mutex> hold(lock);
+            while (true) {
+                ready.wait(hold, [&]() { return written == total || done.count(written); });
+                if (written == total)
+                    return;
+                pair<string, bool> answer = move(done[written]);
+                done.erase(written);
+                hold.unlock();
+
+                if (!failed) {
+                    uint32_t n = answer.first.size();
+                    char header[5] = {(char)n, (char)(n >> 8), (char)(n >> 16), (char)(n >> 24), answer.second};
+                    if (!writeFull(out, header, sizeof header) || !writeFull(out, answer.first.data(), n))
+                        failed = true;
+                }
+
+                hold.lock();
+                written++;
+                room.notify_one();
+            }
+        }
+
+    private:
+        int out;
+        uint64_t window;
+        mutex lock;
+        condition_variable ready; // An answer came in, or the count is known
+        condition_variable room;  // An answer went out
+        map< uint64_t, pair<string, bool> > done;
+        uint64_t written = 0;
+        uint64_t total = UINT64_MAX;
+        atomic<bool> failed{false};
+};
+
+// One maze to solve, and the stream its answer goes to.
+struct Job
+{
+    Stream *stream;
+    uint64_t seq;
+    string maze;
+};
+
+// The solver threads, shared by every stream. Each thread keeps one
+// MazeSolver for its whole life. cache may be null.
+class SolverPool
+{
+    public:
+        SolverPool(int threads, SolveEngine engine, SolveCache *cache) :
+            engine(engine), cache(cache), solvers(threads)
+        {
+            for (int i = 0; i < threads; i++)
+                workers.emplace_back([this, i]() { work(i); });
+        }
+
+        ~SolverPool()
+        {
+            {
+                lock_guard<mutex> hold(lock);
+                stopping = true;
+            }
+            wake.notify_all();
+            for (thread &t : workers)
+                t.join();
+        }
+
+        int size() const { return workers.size(); }
+        SolveCache *solveCache() const { return cache; }
+
+        void submit(Job &&job)
+        {
+            lock_guard<mutex> hold(lock);
+            jobs.push_back(move(job));
+            wake.notify_one();
+        }
+
+    private:
+        void work(int worker)
+        {
+            // Warm the buffers up before the first request.
+            MazeSolver &solver = solvers[worker];
+            string warm = generateMaze(MAZE_ROOMS, 256, 256, worker + 1);
+            solver.solveInto(warm, &warm[0], engine);
+
+            while (true) {
+                Job job;
+                {
+                    unique_lock<mutex> hold(lock);
+                    wake.wait(hold, [&]() { return stopping || !jobs.empty(); });
+                    if (jobs.empty())
+                        return;
+                    job = move(jobs.front());
+                    jobs.pop_front();
+                }
+                // Solve in place: the request buffer becomes the answer.
+                bool found = cache ? cache->solveInto(solver, job.maze, &job.maze[0], engine)
+                                   : solver.solveInto(job.maze, &job.maze[0], engine);
+                job.stream->finish(job.seq, move(job.maze), found);
+            }
+        }
+
+        SolveEngine engine;
+        SolveCache *cache;
+        vector<MazeSolver> solvers;
+        vector<thread> workers;
+        mutex lock;
+        condition_variable wake;
+        deque<Job> jobs;
+        bool stopping = false;
+};
+
+// Helper function: serves one stream of requests from in, answering
+// on out, until in ends or out fails.
+static void serve(SolverPool &solvers, int in, int out) {
+    Stream stream(out, 2 * solvers.size() + 2);
+    thread writer([&]() { stream.writeAll(); });
+
+    uint64_t seq = 0;
+    char header[4];
+    while (readFull(in, header, sizeof header)) {
+        const unsigned char *b = (const unsigned char *)header;
+        uint32_t n = b[0] | b[1] << 8 | b[2] << 16 | (uint32_t)b[3] << 24;
+        if (n > MAX_REQUEST) {
+            fprintf(stderr, "solverd: request of %u bytes is too long\n", n);
+            break;
+        }
+        string maze(n, '\0');
+        if (!readFull(in, &maze[0], n) || !stream.admit(seq))
+            break;
+        solvers.submit({&stream, seq++, move(maze)});
+    }
+
+    stream.close(seq);
+    writer.join();
+
+    if (SolveCache *cache = solvers.solveCache()) {
+        SolveCacheStats stats = cache->stats();
+        fprintf(stderr, "solverd: cache %zu hits, %zu misses, %zu evictions, %zu entries in %zu bytes\n",
+                stats.hits, stats.misses, stats.evictions, stats.entries, stats.bytes);
+    }
+}
+
+// Helper function: opens a Unix domain socket listening at path,
+// replacing any stale socket file. Returns -1 on failure.
+static int listenAt(const char *path) {
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof addr);
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof addr.sun_path) {
+        fprintf(stderr, "solverd: socket path too long: %s\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("solverd: socket");
+        return -1;
+    }
+    unlink(path);
+    if (bind(fd, (sockaddr *)&addr, sizeof addr) < 0 || listen(fd, 64) < 0) {
+        perror("solverd: bind");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int usage() {
+    fprintf(stderr, "usage: solverd [--threads N]\n"
+                    "               [--engine heap|bucket|astar|implicit|parallel|bitbfs|jps|auto|corridor]\n"
+                    "               [--cache BYTES] [--socket PATH]\n");
+    return 2;
+}
+
+int main(int argc, char **argv) {
+    int threads = thread::hardware_concurrency();
+    SolveEngine engine = ENGINE_AUTO;
+    const char *socketPath = nullptr;
+    size_t cacheBytes = 0;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (i + 1 >= argc)
+            return usage();
+        string value = argv[++i];
+        if (arg == "--threads") {
+            threads = atoi(value.c_str());
+        } else if (arg == "--engine") {
+            if (!parseSolveEngine(value, engine))
+                return usage();
+        } else if (arg == "--cache") {
+            cacheBytes = strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "--socket") {
+            socketPath = argv[i];
+        } else {
+            return usage();
+        }
+    }
+    if (threads < 1)
+        threads = 1;
+
+    // A client that hangs up shows as a failed write, not a signal.
+    signal(SIGPIPE, SIG_IGN);
+
+    unique_ptr<SolveCache> cache;
+    if (cacheBytes > 0)
+        cache.reset(new SolveCache(cacheBytes));
+    SolverPool solvers(threads, engine, cache.get());
+    if (!socketPath) {
+        serve(solvers, 0, 1);
+        return 0;
+    }
+
+    int listener = listenAt(socketPath);
+    if (listener < 0)
+        return 1;
+    while (true) {
+        int fd = accept(listener, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            perror("solverd: accept");
+            return 1;
+        }
+        thread([&solvers, fd]() {
+            serve(solvers, fd, fd);
+            close(fd);
+        }).detach();
+    }
+}
@@ -0,0 +1,123 @@
+#ifndef SOLVESTATS_H
+#define SOLVESTATS_H
+
+#include <chrono>
+#include <cstddef>
+
+using namespace std;
+
+// What one solve did, for finding out where a slow maze spends its
+// time. Times are in nanoseconds.
+//
+// The solvers only measure themselves when built with -DMAZE_STATS.
+// Otherwise the counters and timers below are empty inline functions,
+// the search loops compile as if they were not there, and a SolveStats
+// handed to solveInto() comes back all zeros.
+struct SolveStats
+{
+    long long parseNs = 0;  // Splitting the maze into rows
+    long long scanNs = 0;   // Finding the exits, portals and walls
+    long long buildNs = 0;  // Building the graph, for the engines that use one
+    long long searchNs = 0;
+    long long renderNs = 0; // Marking the path in the output
+
+    size_t vertices = 0;    // 0 for the engines that search the grid directly
+    size_t edges = 0;       // Directed edges, portal jumps included
+
+    size_t pushes = 0;
+    size_t pops = 0;
+    size_t decreaseKeys = 0;
+    size_t maxQueued = 0;   // Most entries waiting in the queue at once
+    size_t settled = 0;     // Cells whose final cost the search fixed
+    size_t pathLength = 0;  // Cells on the path, both exits included
+};
+
+#ifdef MAZE_STATS
+
+// Counts the work of one search. Each SearchScratch has one; the
+// searches bump it and MazeSolver copies it into the SolveStats.
+class SearchCounters
+{
+    public:
+        static constexpr bool enabled = true;
+
+        void clear() { *this = SearchCounters(); }
+
+        // n pushes that left queued entries in the queue.
+        void push(size_t queued, size_t n = 1)
+        {
+            counts.pushes += n;
+            if (queued > counts.maxQueued)
+                counts.maxQueued = queued;
+        }
+        void pop(size_t n = 1) { counts.pops += n; }
+        void decreaseKey() { counts.decreaseKeys++; }
+        void settle(size_t n = 1) { counts.settled += n; }
+        void built(size_t vertices, size_t edges)
+        {
+            counts.vertices = vertices;
+            counts.edges = edges;
+        }
+        void pathCell(size_t n = 1) { counts.pathLength += n; }
+
+        // Copies the counts into stats, leaving its times alone.
+        void report(SolveStats &stats) const
+        {
+            stats.vertices = counts.vertices;
+            stats.edges = counts.edges;
+            stats.pushes = counts.pushes;
+            stats.pops = counts.pops;
+            stats.decreaseKeys = counts.decreaseKeys;
+            stats.maxQueued = counts.maxQueued;
+            stats.settled = counts.settled;
+            stats.pathLength = counts.pathLength;
+        }
+
+    private:
+        SolveStats counts;
+};
+
+// Times consecutive phases of a solve.
+class PhaseTimer
+{
+    public:
+        PhaseTimer() : last(chrono::steady_clock::now()) {}
+
+        // Adds the time since the previous lap to ns.
+        void lap(long long &ns)
+        {
+            chrono::steady_clock::time_point now = chrono::steady_clock::now();
+            ns += chrono::duration_cast<chrono::nanoseconds>(now - last).count();
+            last = now;
+        }
+
+    private:
+        chrono::steady_clock::time_point last;
+};
+
+#else
+
+class SearchCounters
+{
+    public:
+        static constexpr bool enabled = false;
+
+        void clear() {}
+        void push(size_t, size_t = 1) {}
+        void pop(size_t = 1) {}
+        void decreaseKey() {}
+        void settle(size_t = 1) {}
+        void built(size_t, size_t) {}
+        void pathCell(size_t = 1) {}
+        void report(SolveStats &) const {}
+};
+
+class PhaseTimer
+{
+    public:
+        void lap(long long &) {}
+};
+
+#endif
+
+#endif
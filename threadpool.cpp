@@ -0,0 +1,108 @@
+#include "threadpool.h"
+
+using namespace std;
+
+ThreadPool::ThreadPool(int threads) {
+    if (threads <= 0)
+        threads = thread::hardware_concurrency();
+    if (threads <= 0)
+        threads = 1;
+    for (int i = 0; i < threads; i++)
+        queues.push_back(unique_ptr<WorkQueue>(new WorkQueue()));
+    for (int i = 1; i < threads; i++)
+        this->threads.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (thread &t : threads)
+        t.join();
+}
+
+ThreadPool &ThreadPool::shared() {
+    static ThreadPool pool(0);
+    return pool;
+}
+
+// Helper function: parallelFor() across the workers.
+void ThreadPool::run(size_t n, size_t grain, Invoke invoke, const void *body) {
+    lock_guard<mutex> turn(calls);
+
+    // Deal each worker a contiguous share of the chunks.
+    size_t chunkCount = (n + grain - 1) / grain;
+    size_t workers = queues.size();
+    for (size_t w = 0; w < workers; w++) {
+        size_t first = chunkCount * w / workers;
+        size_t last = chunkCount * (w + 1) / workers;
+        lock_guard<mutex> guard(queues[w]->lock);
+        for (size_t k = first; k < last; k++)
+            queues[w]->chunks.push_back({k * grain, min(n, (k + 1) * grain)});
+    }
+
+    {
+        lock_guard<mutex> guard(lock);
+        this->invoke = invoke;
+        job = body;
+        busy = threads.size();
+        generation++;
+    }
+    wake.notify_all();
+
+    drain(0);
+
+    unique_lock<mutex> guard(lock);
+    finished.wait(guard, [this] { return busy == 0; });
+    this->invoke = nullptr;
+    job = nullptr;
+}
+
+void ThreadPool::workerLoop(int worker) {
+    unsigned long seen = 0;
+    while (true) {
+        {
+            unique_lock<mutex> guard(lock);
+            wake.wait(guard, [&] { return stopping || generation != seen; });
+            if (stopping)
+                return;
+            seen = generation;
+        }
+        drain(worker);
+        {
+            lock_guard<mutex> guard(lock);
+            busy--;
+        }
+        finished.notify_one();
+    }
+}
+
+// Helper function: runs chunks until none are left anywhere.
+void ThreadPool::drain(int worker) {
+    pair<size_t, size_t> chunk;
+    while (take(worker, chunk))
+        invoke(job, chunk.first, chunk.second, worker);
+}
+
+// Helper function: takes the worker's own newest chunk, or else
+// steals the oldest chunk of another worker.
+bool ThreadPool::take(int worker, pair<size_t, size_t> &chunk) {
+    int workers = queues.size();
+    for (int k = 0; k < workers; k++) {
+        WorkQueue &q = *queues[(worker + k) % workers];
+        lock_guard<mutex> guard(q.lock);
+        if (q.chunks.empty())
+            continue;
+        if (k == 0) {
+            chunk = q.chunks.back();
+            q.chunks.pop_back();
+        } else {
+            chunk = q.chunks.front();
+            q.chunks.pop_front();
+        }
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,96 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// A fixed set of worker threads that run parallel loops with
+// work stealing.
+//
+// parallelFor() cuts the index range into chunks and deals each
+// worker a contiguous share. A worker takes chunks from the back of
+// its own deque and, once that is empty, steals from the front of
+// the others', so a few slow chunks do not leave threads idle.
+// The calling thread takes part as worker 0.
+//
+// A loop of a single chunk, or on a pool of one worker, runs on the
+// calling thread alone without waking any other, so a caller can
+// issue many tiny loops cheaply. Loops from different threads take
+// turns on the workers, so one pool can be shared by every caller.
+class ThreadPool
+{
+    public:
+        // Starts a pool of the given number of workers, the caller
+        // included. 0 means one per hardware thread.
+        ThreadPool(int threads);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        // A pool of one worker per hardware thread, started on first
+        // use and shared by the whole process.
+        static ThreadPool &shared();
+
+        // Returns the number of workers, the caller included.
+        int size() const { return queues.size(); }
+
+        // Calls body(begin, end, worker) over chunks of at most grain
+        // indices that together cover [0, n), and returns when every
+        // call has returned. worker is in [0, size()) and no two calls
+        // of the same loop with the same worker run at once, so it can
+        // pick per-thread scratch space. body must not call
+        // parallelFor() on the same pool.
+        template <typename Body>
+        void parallelFor(size_t n, size_t grain, const Body &body)
+        {
+            if (grain == 0)
+                grain = 1;
+            if (n <= grain || queues.size() == 1) {
+                for (size_t begin = 0; begin < n; begin += grain)
+                    body(begin, min(n, begin + grain), 0);
+                return;
+            }
+            run(n, grain, [](const void *f, size_t begin, size_t end, int worker) {
+                (*(const Body *)f)(begin, end, worker);
+            }, &body);
+        }
+
+    private:
+        typedef void (*Invoke)(const void *body, size_t begin, size_t end, int worker);
+
+        struct WorkQueue
+        {
+            mutex lock;
+            deque< pair<size_t, size_t> > chunks;
+        };
+
+        void run(size_t n, size_t grain, Invoke invoke, const void *body);
+        void workerLoop(int worker);
+        void drain(int worker);
+        bool take(int worker, pair<size_t, size_t> &chunk);
+
+        vector<unique_ptr<WorkQueue> > queues;
+        vector<thread> threads;
+
+        mutex calls;                  // Held by the loop running on the workers
+        mutex lock;
+        condition_variable wake;
+        condition_variable finished;
+        unsigned long generation = 0; // Bumped for each loop
+        int busy = 0;                 // Helper threads still draining
+        bool stopping = false;
+        Invoke invoke = nullptr;      // The running loop's body
+        const void *job = nullptr;
+};
+
+#endif
@@ -0,0 +1,408 @@
+#include <algorithm>
+#include "portalheuristic.h"
+#include "tiledmaze.h"
+
+using namespace std;
+
+TiledMaze::TiledMaze(string_view maze) : TiledMaze(maze, 32) {
+}
+
+TiledMaze::TiledMaze(string_view maze, int tileSide) : cells(maze) {
+    side = min(max(tileSide, 2), 255);
+    tilesDown = (cells.rows() + side - 1) / side;
+    tilesAcross = (cells.cols() + side - 1) / side;
+    tiles.resize((size_t)tilesDown * tilesAcross);
+    for (int tr = 0; tr < tilesDown; tr++) {
+        for (int tc = 0; tc < tilesAcross; tc++) {
+            Tile &t = tiles[(size_t)tr * tilesAcross + tc];
+            t.row0 = tr * side;
+            t.col0 = tc * side;
+            t.rows = min(side, cells.rows() - t.row0);
+            t.cols = min(side, cells.cols() - t.col0);
+        }
+    }
+
+    size_t size = (size_t)cells.rows() * cells.stride();
+    costSoFar.assign(size, 0);
+    bound.assign(size, 0);
+    parent.assign(size, NONE);
+    stamp.assign(size, 0);
+    frontier.reserve(size);
+}
+
+// Helper function: the index in tiles of the tile holding cell.
+int TiledMaze::tileOf(uint32_t cell) const {
+    return (cell / cells.stride() / side) * tilesAcross + cell % cells.stride() / side;
+}
+
+// Helper function: the position of cell within tile t, which holds it.
+int TiledMaze::localIndex(const Tile &t, uint32_t cell) const {
+    return (cell / cells.stride() - t.row0) * side + (cell % cells.stride() - t.col0);
+}
+
+// Helper function: marks stale the tile holding (row, col) and the
+// tiles beside it, whose entrances depend on whether it is open.
+void TiledMaze::markStale(int row, int col) {
+    const int dr[5] = {0, -1, 1, 0, 0};
+    const int dc[5] = {0, 0, 0, -1, 1};
+    for (int i = 0; i < 5; i++) {
+        int r = row + dr[i], c = col + dc[i];
+        if (r >= 0 && r < cells.rows() && c >= 0 && c < cells.cols())
+            tiles[(size_t)(r / side) * tilesAcross + c / side].stale = true;
+    }
+}
+
+bool TiledMaze::update(int row, int col, char ch) {
+    if (!cells.set(row, col, ch))
+        return false;
+
+    // Portals are found at query time, so only the tiles whose cells
+    // can be stood on changed need rebuilding.
+    markStale(row, col);
+    return true;
+}
+
+void TiledMaze::rebuildTile(int tileRow, int tileCol) {
+    if (tileRow < 0 || tileRow >= tilesDown || tileCol < 0 || tileCol >= tilesAcross)
+        return;
+    Tile &t = tiles[(size_t)tileRow * tilesAcross + tileCol];
+    if (t.stale)
+        rebuild(t);
+}
+
+// Helper function: adds to t an entrance for each run of open cells
+// with an open cell across, among the count cells from first on, step
+// apart.
+void TiledMaze::addEntrances(Tile &t, uint32_t first, uint32_t step, int count, int across) {
+    int length = 0;
+    for (int i = 0; i <= count; i++) {
+        uint32_t cell = first + i * step;
+        if (i < count && cells.open(cell) && cells.open(cell + across)) {
+            length++;
+            continue;
+        }
+        if (length > 0)
+            t.entrances.push_back({cell - length * step, step, length, across});
+        length = 0;
+    }
+}
+
+// Helper function: finds the entrances of tile t and the distances
+// from each.
+void TiledMaze::rebuild(Tile &t) {
+    int stride = cells.stride();
+    int row1 = t.row0 + t.rows - 1, col1 = t.col0 + t.cols - 1;
+    t.entrances.clear();
+    if (t.row0 > 0)
+        addEntrances(t, cells.offset(t.row0, t.col0), 1, t.cols, -stride);
+    if (row1 < cells.rows() - 1)
+        addEntrances(t, cells.offset(row1, t.col0), 1, t.cols, stride);
+    if (t.col0 > 0)
+        addEntrances(t, cells.offset(t.row0, t.col0), stride, t.rows, -1);
+    if (col1 < cells.cols() - 1)
+        addEntrances(t, cells.offset(t.row0, col1), stride, t.rows, 1);
+    for (int r = t.row0; r <= row1; r++) {
+        for (int c = t.col0; c <= col1; c++) {
+            uint32_t cell = cells.offset(r, c);
+            if (cells.at(cell) >= '0' && cells.at(cell) <= '9')
+                t.entrances.push_back({cell, 1, 1, 0});
+        }
+    }
+
+    size_t n = t.entrances.size();
+    tileDist.resize(side * side);
+    t.gap.assign(n * n, FAR);
+    for (size_t i = 0; i < n; i++) {
+        searchTile(t, t.entrances[i], tileDist.data());
+        for (size_t j = 0; j < n; j++) {
+            const Entrance &e = t.entrances[j];
+            for (int k = 0; k < e.length; k++)
+                t.gap[i * n + j] = min(t.gap[i * n + j], tileDist[localIndex(t, e.first + k * e.step)]);
+        }
+    }
+    t.toGoal.clear();
+    t.stale = false;
+}
+
+// Helper function: breadth-first search from every cell of entrance
+// from at once, staying inside tile t. Fills dist with the distance
+// to each position of the tile, or FAR.
+void TiledMaze::searchTile(const Tile &t, const Entrance &from, uint16_t *dist) {
+    uint32_t stride = cells.stride();
+    fill(dist, dist + side * side, FAR);
+    tileQueue.clear();
+    for (int k = 0; k < from.length; k++) {
+        int first = localIndex(t, from.first + k * from.step);
+        dist[first] = 0;
+        tileQueue.push_back(first);
+    }
+    for (size_t head = 0; head < tileQueue.size(); head++) {
+        int here = tileQueue[head];
+        int r = here / side, c = here % side;
+        uint32_t cell = (uint32_t)(t.row0 + r) * stride + t.col0 + c;
+
+        // Up, down, left, right, within the tile.
+        int next[4];
+        uint32_t nextCell[4];
+        int count = 0;
+        if (r > 0)
+            next[count] = here - side, nextCell[count++] = cell - stride;
+        if (r < t.rows - 1)
+            next[count] = here + side, nextCell[count++] = cell + stride;
+        if (c > 0)
+            next[count] = here - 1, nextCell[count++] = cell - 1;
+        if (c < t.cols - 1)
+            next[count] = here + 1, nextCell[count++] = cell + 1;
+        for (int i = 0; i < count; i++) {
+            if (dist[next[i]] != FAR || !cells.open(nextCell[i]))
+                continue;
+            dist[next[i]] = dist[here] + 1;
+            tileQueue.push_back(next[i]);
+        }
+    }
+}
+
+// Helper function: the number of the entrance that starts at cell
+// first and leads across by across, or -1.
+int TiledMaze::findEntrance(uint32_t first, int across) const {
+    int t = tileOf(first);
+    const vector<Entrance> &list = tiles[t].entrances;
+    for (size_t i = 0; i < list.size(); i++) {
+        if (list[i].first == first && list[i].across == across)
+            return firstEntrance[t] + i;
+    }
+    return -1;
+}
+
+// Helper function: Dijkstra over the entrances back from goal. Fills
+// entranceBound with the least cost from each entrance to goal along
+// the steps, jumps and tile distances between entrances, which no
+// path through the cells can beat.
+void TiledMaze::boundEntrances(uint32_t goal) {
+    firstEntrance.resize(tiles.size() + 1);
+    firstEntrance[0] = 0;
+    for (size_t t = 0; t < tiles.size(); t++)
+        firstEntrance[t + 1] = firstEntrance[t] + tiles[t].entrances.size();
+    entranceBound.assign(firstEntrance.back(), UNBOUNDED);
+
+    // The goal is joined to the entrances of its tile.
+    int goalTile = tileOf(goal);
+    const Tile &gt = tiles[goalTile];
+    tileDist.resize(side * side);
+    searchTile(gt, {goal, 1, 1, 0}, tileDist.data());
+    entranceFrontier.clear();
+    auto reach = [&](int e, int cost) {
+        if (entranceBound[e] == UNBOUNDED) {
+            entranceBound[e] = cost;
+            entranceFrontier.push(e, cost);
+        } else if (cost < entranceBound[e]) {
+            entranceBound[e] = cost;
+            entranceFrontier.decrease_key(e, cost);
+        }
+    };
+    for (size_t i = 0; i < gt.entrances.size(); i++) {
+        const Entrance &e = gt.entrances[i];
+        uint16_t d = FAR;
+        for (int k = 0; k < e.length; k++)
+            d = min(d, tileDist[localIndex(gt, e.first + k * e.step)]);
+        if (d != FAR)
+            reach(firstEntrance[goalTile] + i, d);
+    }
+
+    while (entranceFrontier.size() > 0) {
+        uint32_t u = entranceFrontier.front();
+        entranceFrontier.pop();
+        int cost = entranceBound[u];
+        int t = upper_bound(firstEntrance.begin(), firstEntrance.end(), u) - firstEntrance.begin() - 1;
+        const Tile &tile = tiles[t];
+        size_t n = tile.entrances.size(), i = u - firstEntrance[t];
+        const Entrance &e = tile.entrances[i];
+
+        // Within the tile, then across its edge or through the portal.
+        for (size_t j = 0; j < n; j++) {
+            uint16_t d = tile.gap[i * n + j];
+            if (d != FAR && j != i)
+                reach(firstEntrance[t] + j, cost + d);
+        }
+        if (e.across != 0) {
+            int facing = findEntrance(e.first + e.across, -e.across);
+            if (facing >= 0)
+                reach(facing, cost + 1);
+        } else {
+            uint32_t jump = cells.partner(e.first);
+            int other = jump != NONE ? findEntrance(jump, 0) : -1;
+            if (other >= 0)
+                reach(other, cost + (cells.at(e.first) - '0'));
+        }
+    }
+}
+
+// Helper function: fills in toGoal of the tile numbered tile for this
+// query: the least cost from each position to the goal through an
+// entrance of the tile, or straight to the goal if it is there. The
+// entrances' cells start at their bounds and a breadth-first search
+// spreads them through the tile, taking the starts in order of cost.
+void TiledMaze::boundTile(int tile, uint32_t goal) {
+    Tile &t = tiles[tile];
+    t.boundQuery = query;
+
+    // After a local change most entrances keep their bounds, and the
+    // tile then keeps its own.
+    const int *bounds = &entranceBound[firstEntrance[tile]];
+    size_t n = t.entrances.size();
+    uint32_t goalHere = tileOf(goal) == tile ? goal : NONE;
+    if (!t.toGoal.empty() && t.goalUsed == goalHere && equal(bounds, bounds + n, t.boundsUsed.begin()))
+        return;
+    t.boundsUsed.assign(bounds, bounds + n);
+    t.goalUsed = goalHere;
+
+    t.toGoal.assign(side * side, UNBOUNDED);
+    seeds.clear();
+    for (size_t i = 0; i < n; i++) {
+        int rest = bounds[i];
+        const Entrance &e = t.entrances[i];
+        for (int k = 0; rest != UNBOUNDED && k < e.length; k++)
+            seeds.push_back({rest, localIndex(t, e.first + k * e.step)});
+    }
+    if (goalHere != NONE)
+        seeds.push_back({0, localIndex(t, goal)});
+    sort(seeds.begin(), seeds.end());
+
+    uint32_t stride = cells.stride();
+    tileQueue.clear();
+    size_t seed = 0, head = 0;
+    while (seed < seeds.size() || head < tileQueue.size()) {
+        if (head == tileQueue.size() || (seed < seeds.size() && seeds[seed].first <= t.toGoal[tileQueue[head]])) {
+            int here = seeds[seed].second, cost = seeds[seed++].first;
+            if (cost < t.toGoal[here]) {
+                t.toGoal[here] = cost;
+                tileQueue.push_back(here);
+            }
+            continue;
+        }
+        int here = tileQueue[head++];
+        int r = here / side, c = here % side;
+        uint32_t cell = (uint32_t)(t.row0 + r) * stride + t.col0 + c;
+        int cost = t.toGoal[here] + 1;
+
+        // Up, down, left, right, within the tile.
+        int next[4];
+        uint32_t nextCell[4];
+        int count = 0;
+        if (r > 0)
+            next[count] = here - side, nextCell[count++] = cell - stride;
+        if (r < t.rows - 1)
+            next[count] = here + side, nextCell[count++] = cell + stride;
+        if (c > 0)
+            next[count] = here - 1, nextCell[count++] = cell - 1;
+        if (c < t.cols - 1)
+            next[count] = here + 1, nextCell[count++] = cell + 1;
+        for (int i = 0; i < count; i++) {
+            if (cost >= t.toGoal[next[i]] || !cells.open(nextCell[i]))
+                continue;
+            t.toGoal[next[i]] = cost;
+            tileQueue.push_back(next[i]);
+        }
+    }
+}
+
+// Helper function: A* over the cells from start to goal, guided by the
+// entrance bounds. Leaves the path in parent. Returns whether the goal
+// was reached.
+bool TiledMaze::search() {
+    uint32_t start = cells.start(), goal = cells.goal();
+    if (start == NONE || goal == NONE)
+        return false;
+    for (Tile &t : tiles) {
+        if (t.stale)
+            rebuild(t);
+    }
+    boundEntrances(goal);
+    uint32_t stride = cells.stride();
+
+    if (++query == 0) {
+        fill(stamp.begin(), stamp.end(), 0);
+        for (Tile &t : tiles)
+            t.boundQuery = 0;
+        query = 1;
+    }
+
+    // Keys order by cost plus bound, then the deeper cell first, so
+    // among equally good cells the search presses on toward the goal.
+    frontier.clear();
+    auto key = [&](uint32_t cell) {
+        return ((long long)(costSoFar[cell] + bound[cell]) << 32) - costSoFar[cell];
+    };
+    PortalHeuristic estimate(goal / stride, goal % stride);
+    for (int d = 0; d <= 9; d++) {
+        const vector<uint32_t> &ends = cells.digitCells(d);
+        if (ends.size() == 2)
+            estimate.addPortal(ends[0] / stride, ends[0] % stride, ends[1] / stride, ends[1] % stride, d);
+    }
+    auto reach = [&](uint32_t cell, int cost, uint32_t from) {
+        if (stamp[cell] != query) {
+            stamp[cell] = query;
+            int t = tileOf(cell);
+            if (tiles[t].boundQuery != query)
+                boundTile(t, goal);
+            bound[cell] = tiles[t].toGoal[localIndex(tiles[t], cell)];
+            if (bound[cell] != UNBOUNDED)
+                bound[cell] = max(bound[cell], estimate(cell / stride, cell % stride));
+            costSoFar[cell] = cost;
+            parent[cell] = from;
+            if (bound[cell] != UNBOUNDED)
+                frontier.push(cell, key(cell));
+        } else if (cost < costSoFar[cell] && bound[cell] != UNBOUNDED) {
+            costSoFar[cell] = cost;
+            parent[cell] = from;
+            frontier.decrease_key(cell, key(cell));
+        }
+    };
+    reach(start, 0, NONE);
+
+    // The bound never drops by more than a move costs, so each cell is
+    // final when it leaves the queue.
+    size_t size = (size_t)cells.rows() * stride;
+    while (frontier.size() > 0) {
+        uint32_t u = frontier.front();
+        frontier.pop();
+        if (u == goal)
+            return true;
+        int cost = costSoFar[u];
+
+        // Up, down, left, right, then through a portal.
+        uint32_t beside[4] = {
+            u >= stride ? u - stride : NONE,
+            u + stride < size ? u + stride : NONE,
+            u > 0 ? u - 1 : NONE,
+            u + 1
+        };
+        for (int k = 0; k < 4; k++) {
+            if (beside[k] != NONE && cells.open(beside[k]))
+                reach(beside[k], cost + 1, u);
+        }
+        uint32_t jump = cells.partner(u);
+        if (jump != NONE)
+            reach(jump, cost + (cells.at(u) - '0'), u);
+    }
+    return false;
+}
+
+int TiledMaze::cost() {
+    return search() ? costSoFar[cells.goal()] : -1;
+}
+
+string TiledMaze::solve() {
+    string out(cells.text().size(), '\0');
+    solveInto(&out[0]);
+    return out;
+}
+
+bool TiledMaze::solveInto(char *out) {
+    copy(cells.text().begin(), cells.text().end(), out);
+    if (!search())
+        return false;
+    for (uint32_t cur = cells.goal(); cur != NONE; cur = parent[cur])
+        out[cur] = 'o';
+    return true;
+}
@@ -0,0 +1,152 @@
+#ifndef TILEDMAZE_H
+#define TILEDMAZE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "editablemaze.h"
+#include "minpriorityqueue.h"
+
+using namespace std;
+
+// Solves a large maze again and again while a few of its cells change,
+// with distances prepared per square tile, in the manner of HPA*.
+//
+// The grid is cut into square tiles, and each tile keeps its
+// entrances: every run of open cells along one of its edges with open
+// cells across in the next tile, and every digit cell. A search of the
+// tile from each entrance, starting from the whole run at once, gives
+// the distances between its entrances, which the tile keeps.
+//
+// A query first searches the small graph of entrances back from the
+// second exit. Its edges are the distances between entrances inside
+// tiles, the step across each tile edge and the portal jumps, so it
+// gives for each entrance a cost that no path from it to the exit can
+// beat. Then an A* search of the cells goes from the first exit to the
+// second, guided by those costs: a cell can reach the exit no sooner
+// than through the best entrance of its tile, which one search of the
+// tile works out for all its cells when A* first enters it, nor than
+// the Manhattan estimate of PortalHeuristic allows. The estimate never
+// overshoots, so the path is an exact shortest one. Through corridors
+// it is exact, and A* takes only the cells of the path; across open
+// rooms the Manhattan estimate keeps it close to the path.
+//
+// update() only marks the tiles around a changed cell stale; a stale
+// tile is rebuilt on its own before the next query. A tile whose
+// entrances keep their costs from one query to the next also keeps the
+// bounds of its cells.
+//
+// Preparing the tiles costs a search of each tile per entrance. It
+// pays off when the maze is queried again after local changes. Cells
+// are named by their offset in the maze string, as in MazeScan. Not
+// safe to share between threads.
+class TiledMaze
+{
+    public:
+        // Copies maze, cut into tiles of 32 by 32 cells, or of the given
+        // side, from 2 to 255.
+        TiledMaze(string_view maze);
+        TiledMaze(string_view maze, int tileSide);
+
+        // Sets the cell at (row, col) to ch: '#', ' ' or a digit.
+        // Returns false, changing nothing, if (row, col) is outside
+        // the maze or ch is a newline.
+        bool update(int row, int col, char ch);
+
+        // Recomputes the entrances and distances of the tile in the
+        // given row and column of tiles, if it is stale.
+        void rebuildTile(int tileRow, int tileCol);
+
+        // The maze with every update applied.
+        const string &maze() const { return cells.text(); }
+
+        int tileRows() const { return tilesDown; }
+        int tileCols() const { return tilesAcross; }
+
+        // Returns the cost of a shortest path between the exits, or -1
+        // if there is none.
+        int cost();
+
+        // Same as solve(maze()), with the path found through the tiles.
+        string solve();
+
+        // Same as solveInto(maze(), out). Returns whether a path was found.
+        bool solveInto(char *out);
+
+    private:
+        static constexpr uint32_t NONE = EditableMaze::NONE;
+        static constexpr uint16_t FAR = 0xFFFF;
+        static constexpr int UNBOUNDED = 0x7FFFFFFF;
+
+        // length cells from first on, step apart, where a path can enter
+        // or leave a tile. across leads from each to the open cell
+        // facing it in the next tile; it is 0 for a digit cell, which
+        // is left through its portal.
+        struct Entrance
+        {
+            uint32_t first;
+            uint32_t step;
+            int length;
+            int across;
+        };
+
+        struct Tile
+        {
+            int row0 = 0, col0 = 0; // Top left cell
+            int rows = 0, cols = 0;
+            vector<Entrance> entrances;
+            vector<uint16_t> gap;   // From entrance i to entrance j at [i * entrances.size() + j], or FAR
+            bool stale = true;
+
+            // The least cost from each position to the goal through
+            // the entrances, or UNBOUNDED, last worked out for query
+            // boundQuery from the entrance bounds in boundsUsed and
+            // the goal at goalUsed, or NONE if it was elsewhere.
+            vector<int> toGoal;
+            vector<int> boundsUsed;
+            uint32_t goalUsed = NONE;
+            uint32_t boundQuery = 0;
+        };
+
+        int tileOf(uint32_t cell) const;
+        int localIndex(const Tile &t, uint32_t cell) const;
+        void markStale(int row, int col);
+        void rebuild(Tile &t);
+        void addEntrances(Tile &t, uint32_t first, uint32_t step, int count, int across);
+        void searchTile(const Tile &t, const Entrance &from, uint16_t *dist);
+        int findEntrance(uint32_t first, int across) const;
+        void boundEntrances(uint32_t goal);
+        void boundTile(int tile, uint32_t goal);
+        bool search();
+
+        EditableMaze cells;
+        int side = 32;
+        int tilesDown = 0;
+        int tilesAcross = 0;
+        vector<Tile> tiles;
+
+        // The entrances of all tiles, numbered tile by tile from
+        // firstEntrance[t], and the least cost from each to the goal
+        // in the last query, or UNBOUNDED.
+        vector<uint32_t> firstEntrance;
+        vector<int> entranceBound;
+        MinPriorityQueue<uint32_t, 4> entranceFrontier;
+
+        // A* state by cell offset; a cell's cost, bound and parent are
+        // only valid when its stamp matches the current query's.
+        vector<int> costSoFar;
+        vector<int> bound;
+        vector<uint32_t> parent;
+        vector<uint32_t> stamp;
+        uint32_t query = 0;
+        MinPriorityQueue<uint32_t, 4, long long> frontier;
+
+        // Tile search scratch, by position in the tile
+        vector<uint16_t> tileDist;
+        vector<uint16_t> tileQueue;
+        vector< pair<int, uint16_t> > seeds;
+};
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef VIEWARRAY_H
+#define VIEWARRAY_H
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+using namespace std;
+
+// An array that either owns its elements, in a pmr::vector, or views
+// elements that live elsewhere, such as a section of a mapped packed
+// maze. Reading costs the same either way. Anything that fills it
+// (clear, assign, resize, push_back) drops the view and fills the
+// owned vector; a view stays valid only as long as what it views.
+template <typename T>
+class ViewArray
+{
+    public:
+        ViewArray() {}
+        ViewArray(pmr::memory_resource *memory) : owned(memory) {}
+
+        ViewArray(const ViewArray &other) : owned(other.owned)
+        {
+            copyView(other);
+        }
+
+        ViewArray &operator=(const ViewArray &other)
+        {
+            owned = other.owned;
+            copyView(other);
+            return *this;
+        }
+
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        const T &operator[](size_t i) const { return items[i]; }
+        const T *data() const { return items; }
+        const T *begin() const { return items; }
+        const T *end() const { return items + count; }
+
+        // Views the n elements at p, which must outlive the view.
+        void view(const T *p, size_t n)
+        {
+            owned.clear();
+            items = p;
+            count = n;
+        }
+
+        void clear() { owned.clear(); sync(); }
+        void reserve(size_t n) { owned.reserve(n); sync(); }
+        void resize(size_t n) { owned.resize(n); sync(); }
+        void assign(size_t n, const T &value) { owned.assign(n, value); sync(); }
+        void push_back(const T &value) { owned.push_back(value); sync(); }
+
+        // The owned elements, to fill in place after assign() or resize().
+        T *writable() { return owned.data(); }
+
+    private:
+        void sync()
+        {
+            items = owned.data();
+            count = owned.size();
+        }
+
+        void copyView(const ViewArray &other)
+        {
+            if (other.items == other.owned.data())
+                sync();
+            else
+                view(other.items, other.count);
+        }
+
+        pmr::vector<T> owned;
+        const T *items = nullptr;
+        size_t count = 0;
+};
+
+#endif